@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "enums.h"
+#include "coord.h"
+#include "move.h"
+#include "attack.h"
+#include "utils.h"
+
+// A single player action in a compact, generator independent form. Moves and attacks are
+// identified the same way the REPL identifies them, so an action can be recorded and later
+// matched against (or turned back into) the Move or Attack the generators produce.
+class Action
+{
+public:
+    ActionType type;
+    // The machine being moved, rotated or attacking with. Unused for EndTurn.
+    Coord source;
+    // Move only. The space the machine moves to.
+    Coord destination;
+    // Attack and Rotate only. The attack direction or the new facing.
+    MachineDirection direction;
+    // Move and Attack only. Whether the action overcharges the machine.
+    bool overcharge;
+    // Move only. Whether the move needs a sprint.
+    bool sprint;
+
+    Action(
+        ActionType type,
+        Coord source,
+        Coord destination,
+        MachineDirection direction,
+        bool overcharge,
+        bool sprint) : type(type),
+                       source(source),
+                       destination(destination),
+                       direction(direction),
+                       overcharge(overcharge),
+                       sprint(sprint) {}
+
+    static Action end_turn()
+    {
+        return Action(ActionType::EndTurn, {0, 0}, {0, 0}, MachineDirection::North, false, false);
+    }
+
+    static Action rotate(Coord source, MachineDirection direction)
+    {
+        return Action(ActionType::Rotate, source, {0, 0}, direction, false, false);
+    }
+
+    static Action from_move(const Move &move)
+    {
+        return Action(ActionType::Move, move.source, move.destination, MachineDirection::North, move.causes_state == MachineState::Overcharged, move.causes_state == MachineState::Sprinted);
+    }
+
+    static Action from_attack(const Attack &attack)
+    {
+        return Action(ActionType::Attack, attack.source, {0, 0}, attack.attack_direction_from_source, attack.causes_state == MachineState::Overcharged, false);
+    }
+
+    bool matches(const Move &move) const
+    {
+        return type == ActionType::Move && source == move.source && destination == move.destination && overcharge == (move.causes_state == MachineState::Overcharged) && sprint == (move.causes_state == MachineState::Sprinted);
+    }
+
+    bool matches(const Attack &attack) const
+    {
+        return type == ActionType::Attack && source == attack.source && direction == attack.attack_direction_from_source && overcharge == (attack.causes_state == MachineState::Overcharged);
+    }
+
+    bool operator==(const Action &other) const
+    {
+        return encode() == other.encode();
+    }
+
+    // Packs the action into 16 bits:
+    //   2 bits  type
+    //   6 bits  source space
+    //   6 bits  destination space (Move) or direction (Attack and Rotate)
+    //   1 bit   overcharge
+    //   1 bit   sprint
+    uint16_t encode() const
+    {
+        uint16_t payload = 0;
+        if (type == ActionType::Move)
+            payload = destination.row * 8 + destination.column;
+        else if (type == ActionType::Attack || type == ActionType::Rotate)
+            payload = static_cast<uint16_t>(direction);
+
+        uint16_t space = type == ActionType::EndTurn ? 0 : source.row * 8 + source.column;
+        return static_cast<uint16_t>(type) | space << 2 | payload << 8 | overcharge << 14 | sprint << 15;
+    }
+
+    static Action decode(uint16_t value)
+    {
+        auto type = static_cast<ActionType>(value & 0x3);
+        auto space = (value >> 2) & 0x3F;
+        auto payload = (value >> 8) & 0x3F;
+        Coord source{space / 8, space % 8};
+
+        switch (type)
+        {
+        case ActionType::EndTurn:
+            return end_turn();
+        case ActionType::Rotate:
+            return rotate(source, static_cast<MachineDirection>(payload & 0x3));
+        case ActionType::Move:
+            return Action(type, source, {payload / 8, payload % 8}, MachineDirection::North, (value >> 14) & 1, (value >> 15) & 1);
+        default:
+            return Action(type, source, {0, 0}, static_cast<MachineDirection>(payload & 0x3), (value >> 14) & 1, false);
+        }
+    }
+
+    // The same action on the board reflected across its vertical axis.
+    Action mirrored() const
+    {
+        if (type == ActionType::EndTurn)
+            return *this;
+
+        return Action(type, mirror_coord(source), type == ActionType::Move ? mirror_coord(destination) : destination, mirror_direction(direction), overcharge, sprint);
+    }
+
+    // Returns the REPL command that performs this action.
+    std::string to_string() const
+    {
+        static const char *attack_directions[] = {"north", "east", "south", "west"};
+        static const char *rotate_directions[] = {"N", "E", "S", "W"};
+        auto coords = std::to_string(source.row) + " " + std::to_string(source.column);
+
+        switch (type)
+        {
+        case ActionType::EndTurn:
+            return "endturn";
+        case ActionType::Rotate:
+            return "rotate " + coords + " " + rotate_directions[static_cast<int>(direction)];
+        case ActionType::Move:
+            return "move " + coords + " " + std::to_string(destination.row) + " " + std::to_string(destination.column) + (overcharge ? " true" : " false");
+        default:
+            return "attack " + coords + " " + attack_directions[static_cast<int>(direction)] + (overcharge ? " true" : " false");
+        }
+    }
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "coord.h"
+#include "enums.h"
+#include "game_machine.h"
+#include "types.h"
+
+// Where a machine an attack touched ends up.
+class PredictedMachine
+{
+public:
+    GameMachine *machine;
+    Coord coordinates;
+    int32_t health;
+    MachineDirection direction;
+
+    bool killed() const { return health <= 0; }
+    // Health lost to the attack, including knockback and overcharge damage.
+    int32_t damage() const { return machine->health - health; }
+};
+
+// The result of an attack, played out on a scratch copy of the board by Game::predict_attack.
+class AttackPrediction
+{
+public:
+    // Every machine the attack moved, turned or damaged, the attacker first.
+    std::vector<PredictedMachine> machines;
+    // Victory points each side gains.
+    int32_t player_victory_points = 0;
+    int32_t opponent_victory_points = 0;
+    int32_t defense_breaks = 0;
+
+    // Victory points the given side gains, less those the other side gains.
+    int32_t victory_point_swing(Player side) const
+    {
+        return side == Player::Player ? player_victory_points - opponent_victory_points : opponent_victory_points - player_victory_points;
+    }
+
+    // Health the given side's machines lose, less the health the other side's machines lose.
+    int32_t damage_taken(Player side) const
+    {
+        int32_t damage = 0;
+        for (const auto &machine : machines)
+            damage += machine.machine->side == side ? machine.damage() : -machine.damage();
+        return damage;
+    }
+};
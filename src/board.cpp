@@ -1,8 +1,49 @@
 #include <optional>
 #include <memory>
 #include "board.h"
+#include "machine_table.h"
+#include "zobrist.h"
 
-Board::Board(BoardType<Terrain> terrain, BoardType<GameMachine*> machines) : terrain(terrain), machines(machines) {}
+static uint64_t space_bit(Coord coord)
+{
+    return uint64_t(1) << (coord.row * 8 + coord.column);
+}
+
+static uint64_t terrain_key(Coord coord, Terrain value)
+{
+    return ZOBRIST.terrain[coord.row * 8 + coord.column][static_cast<int32_t>(value) - static_cast<int32_t>(Terrain::Chasm)];
+}
+
+TerrainLayer::TerrainLayer(BoardType<Terrain> spaces) : spaces(spaces)
+{
+    for (int row = 0; row < 8; ++row)
+    {
+        for (int column = 0; column < 8; ++column)
+        {
+            Coord coord = {row, column};
+            hash ^= terrain_key(coord, spaces[coord]);
+            if (spaces[coord] == Terrain::Chasm)
+                chasm_mask |= space_bit(coord);
+        }
+    }
+}
+
+Board::Board(BoardType<Terrain> terrain, BoardType<GameMachine*> machines) : terrain(std::make_shared<const TerrainLayer>(terrain)), machines(machines)
+{
+    for (int row = 0; row < 8; ++row)
+    {
+        for (int column = 0; column < 8; ++column)
+        {
+            if (machines[{row, column}] != nullptr)
+                toggle_masks({row, column}, machines[{row, column}]);
+        }
+    }
+}
+
+Board::Board(const Board &other, BoardType<GameMachine*> machines) : terrain(other.terrain), machines(machines), occupied_mask(other.occupied_mask),
+                                                                  side_masks(other.side_masks), reach_masks(other.reach_masks)
+{
+}
 
 void Board::move_machine(Coord source, Coord destination)
 {
@@ -12,6 +53,8 @@ void Board::move_machine(Coord source, Coord destination)
     machines[destination] = machines[source];
     machines[source] = nullptr;
     machines[destination]->coordinates = destination;
+    toggle_masks(source, machines[destination]);
+    toggle_masks(destination, machines[destination]);
 }
 
 bool Board::is_space_occupied(Coord coord)
@@ -41,9 +84,25 @@ BoardIterator Board::end()
     return BoardIterator(this, {8, 0});
 }
 
-Terrain &Board::terrain_at(Coord coordinates)
+Terrain Board::terrain_at(Coord coordinates) const
 {
-    return terrain[coordinates];
+    return terrain->spaces.data[coordinates.row][coordinates.column];
+}
+
+void Board::set_terrain(Coord coordinates, Terrain value)
+{
+    if (terrain_at(coordinates) == value)
+        return;
+
+    // Other boards may share the current layer, so the change goes into a copy.
+    auto changed = std::make_shared<TerrainLayer>(*terrain);
+    changed->hash ^= terrain_key(coordinates, terrain_at(coordinates)) ^ terrain_key(coordinates, value);
+    if (value == Terrain::Chasm)
+        changed->chasm_mask |= space_bit(coordinates);
+    else
+        changed->chasm_mask &= ~space_bit(coordinates);
+    changed->spaces[coordinates] = value;
+    terrain = std::move(changed);
 }
 
 GameMachine* Board::machine_at(Coord coordinates)
@@ -53,5 +112,16 @@ GameMachine* Board::machine_at(Coord coordinates)
 
 void Board::clear_spot(Coord coord)
 {
+    if (machines[coord] != nullptr)
+        toggle_masks(coord, machines[coord]);
     machines[coord] = nullptr;
+}
+
+void Board::toggle_masks(Coord coord, const GameMachine *machine)
+{
+    auto bit = space_bit(coord);
+    occupied_mask ^= bit;
+    side_masks[static_cast<int32_t>(machine->side)] ^= bit;
+    for (int32_t distance = 1; distance < MACHINE_TABLE.range[machine->id] && distance < 8; ++distance)
+        reach_masks[distance] ^= bit;
 }
\ No newline at end of file
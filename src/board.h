@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include "types.h"
 #include <optional>
 #include <vector>
@@ -11,20 +13,49 @@
 
 class BoardIterator;
 
+// A board's terrain, which never changes once built. Boards copied from one another share the same layer, and
+// Board::set_terrain swaps in a changed copy rather than writing to it.
+class TerrainLayer
+{
+public:
+    BoardType<Terrain> spaces;
+    // The XOR of the Zobrist keys of every space's terrain, usable as a key for anything that only depends on terrain.
+    uint64_t hash = 0;
+    // A bit per space (1 << (row * 8 + column)) that is a chasm.
+    uint64_t chasm_mask = 0;
+
+    TerrainLayer(BoardType<Terrain> spaces);
+};
+
 class Board
 {
 public:
-    BoardType<Terrain> terrain;
+    std::shared_ptr<const TerrainLayer> terrain;
     BoardType<GameMachine*> machines;
+    // A bit per space that holds a machine, kept up to date by move_machine and clear_spot.
+    uint64_t occupied_mask = 0;
+    // The spaces holding each side's machines, indexed by Player.
+    std::array<uint64_t, 2> side_masks{};
+    // For each distance, the spaces holding a machine with the spaces that far along its row and column in attack range.
+    // Together with side_masks, enough for Game's threat queries without walking the board. Kept up to date alongside
+    // occupied_mask; nothing else a machine's range depends on can change.
+    std::array<uint64_t, 8> reach_masks{};
 
     Board(BoardType<Terrain> terrain, BoardType<GameMachine*> machines);
+    // The same terrain as other, with machines standing where other's do.
+    Board(const Board &other, BoardType<GameMachine*> machines);
     void move_machine(Coord source, Coord destination);
     bool is_space_occupied(Coord coord);
     BoardIterator begin();
     BoardIterator end();
-    Terrain &terrain_at(Coord coordinates);
+    Terrain terrain_at(Coord coordinates) const;
+    void set_terrain(Coord coordinates, Terrain value);
     GameMachine* machine_at(Coord coordinates);
     void clear_spot(Coord coord);
+
+private:
+    // Adds the machine at the space to the masks, or takes it out if it is already in them.
+    void toggle_masks(Coord coord, const GameMachine *machine);
 };
 
 class BoardIterator
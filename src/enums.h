@@ -149,12 +149,12 @@ enum class MachineSide
     Rear = 1 << 3,
 };
 
-inline MachineSide operator|(MachineSide a, MachineSide b)
+constexpr MachineSide operator|(MachineSide a, MachineSide b)
 {
     return static_cast<MachineSide>(static_cast<int>(a) | static_cast<int>(b));
 }
 
-inline MachineSide operator&(MachineSide a, MachineSide b)
+constexpr MachineSide operator&(MachineSide a, MachineSide b)
 {
     return static_cast<MachineSide>(static_cast<int>(a) & static_cast<int>(b));
 }
@@ -218,4 +218,28 @@ enum class GameState
      * The player can rotate their machines or end their turn (or overcharge any machines that can be overcharged).
      */
     MustEndTurn,
-};
\ No newline at end of file
+};
+
+enum class ActionType
+{
+    EndTurn,
+    Rotate,
+    Move,
+    Attack,
+};
+
+enum class ScoreBound
+{
+    /**
+     * The score is exact.
+     */
+    Exact,
+    /**
+     * The search failed high. The real score is at least this.
+     */
+    Lower,
+    /**
+     * The search failed low. The real score is at most this.
+     */
+    Upper,
+};
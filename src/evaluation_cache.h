@@ -0,0 +1,39 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+class EvaluationCacheEntry
+{
+public:
+    uint64_t key = 0;
+    int32_t score = 0;
+    bool occupied = false;
+};
+
+// A direct mapped cache of leaf scores keyed by Game::hash, where a new score always replaces the old one. Each search
+// thread has its own, so it needs no locking.
+class EvaluationCache
+{
+    std::vector<EvaluationCacheEntry> entries;
+    uint64_t mask = 0;
+
+public:
+    // Rounded down to a power of two. Zero entries makes a cache that never hits.
+    EvaluationCache(size_t entry_count) : entries(entry_count == 0 ? 0 : std::bit_floor(entry_count)), mask(entries.empty() ? 0 : entries.size() - 1) {}
+
+    bool enabled() const { return !entries.empty(); }
+
+    std::optional<int32_t> probe(uint64_t key) const
+    {
+        const auto &entry = entries[key & mask];
+        return entry.occupied && entry.key == key ? std::optional<int32_t>(entry.score) : std::nullopt;
+    }
+
+    void store(uint64_t key, int32_t score)
+    {
+        entries[key & mask] = EvaluationCacheEntry{key, score, true};
+    }
+};
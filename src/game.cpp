@@ -1,4 +1,6 @@
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <iostream>
 #include <cstdint>
 #include <ranges>
@@ -7,6 +9,9 @@
 #include "game.h"
 #include "attack.h"
 #include "utils.h"
+#include "machine_table.h"
+#include "object_pool.h"
+#include "trace.h"
 Game::Game(BoardType<std::optional<GameMachine>> machines, BoardType<Terrain> terrain, Player turn) : turn(turn)
 {
     BoardType<GameMachine *> board_machines{nullptr};
@@ -19,7 +24,7 @@ Game::Game(BoardType<std::optional<GameMachine>> machines, BoardType<Terrain> te
             if (!machine.has_value())
                 continue;
 
-            auto owned_machine = new GameMachine(machine.value());
+            auto owned_machine = ObjectPool<GameMachine>::create(machine.value());
             board_machines[{row, column}] = owned_machine;
 
             if (owned_machine->side == Player::Player)
@@ -29,21 +34,23 @@ Game::Game(BoardType<std::optional<GameMachine>> machines, BoardType<Terrain> te
         }
     }
 
-    board = new Board(terrain, board_machines);
+    board = ObjectPool<Board>::create(terrain, board_machines);
 }
 
 Game::~Game()
 {
     for (auto machine : player_machines)
-        delete machine;
+        ObjectPool<GameMachine>::destroy(machine);
     for (auto machine : opponent_machines)
-        delete machine;
+        ObjectPool<GameMachine>::destroy(machine);
 
-    delete board;
+    ObjectPool<Board>::destroy(board);
 }
 
-Game::Game(const Game &game) : turn(game.turn), player_victory_points(game.player_victory_points), opponent_victory_points(game.opponent_victory_points), state(game.state), last_touched_machine(game.last_touched_machine), must_move_last_touched_machine(game.must_move_last_touched_machine)
+Game::Game(const Game &game) : turn(game.turn), player_victory_points(game.player_victory_points), opponent_victory_points(game.opponent_victory_points), state(game.state), must_move_last_touched_machine(game.must_move_last_touched_machine)
 {
+    TRACE_ZONE("Game copy");
+
     BoardType<GameMachine *> board_machines{nullptr};
 
     for (int row = 0; row < 8; ++row)
@@ -54,9 +61,12 @@ Game::Game(const Game &game) : turn(game.turn), player_victory_points(game.playe
             if (machine == nullptr)
                 continue;
 
-            auto owned_machine = new GameMachine(machine->machine, machine->direction, machine->coordinates, machine->machine_state, machine->side);
+            auto owned_machine = ObjectPool<GameMachine>::create(*machine);
             board_machines[{row, column}] = owned_machine;
 
+            if (machine == game.last_touched_machine)
+                last_touched_machine = owned_machine;
+
             if (owned_machine->side == Player::Player)
                 player_machines.push_back(owned_machine);
             else
@@ -64,12 +74,14 @@ Game::Game(const Game &game) : turn(game.turn), player_victory_points(game.playe
         }
     }
 
-    board = new Board(game.board->terrain, board_machines);
+    board = ObjectPool<Board>::create(*game.board, board_machines);
 }
 
 int Game::get_turn_machine_count() const
 {
-    return turn == Player::Player ? player_machines.size() : opponent_machines.size();
+    auto &machines = turn == Player::Player ? player_machines : opponent_machines;
+    return std::count_if(machines.begin(), machines.end(), [](const GameMachine *machine)
+                         { return machine->is_alive(); });
 }
 
 void Game::make_move(Move &m)
@@ -93,40 +105,119 @@ void Game::make_move(Move &m)
 
 void Game::make_attack(Attack &attack)
 {
+    TRACE_ZONE("make_attack");
+
     auto attacker = board->machine_at(attack.source);
     last_touched_machine = attacker;
     must_move_last_touched_machine = attacker->machine_state == MachineState::Ready; // If we haven't touched this machine yet and we attack with it, we must then subsequently move it after attacking.
     attacker->direction = attack.attack_direction_from_source;
 
-    switch (attacker->machine.get().machine_type)
+    // Indexed by machine type, in the order MachineType declares them.
+    static constexpr std::array<void (Game::*)(Attack &), 6> perform_attack = {
+        &Game::perform_gunner_attack,
+        &Game::perform_pull_attack,
+        &Game::perform_ram_attack,
+        &Game::perform_melee_attack,
+        &Game::perform_dash_attack,
+        &Game::perform_swoop_attack,
+    };
+    (this->*perform_attack[static_cast<int32_t>(MACHINE_TABLE.machine_type[attacker->id])])(attack);
+
+    attacker->machine_state = attack.causes_state;
+    if (attacker->machine_state == MachineState::Overcharged)
+        modify_machine_health(attacker, -2);
+}
+
+// Applies an action without checking that it is legal. Moves are made directly from the action, attacks are looked up
+// among the attacking machine's generated attacks since the generator is what decides which machines are affected.
+void Game::make_action(const Action &action)
+{
+    switch (action.type)
     {
-    case MachineType::Dash:
-        perform_dash_attack(attack);
-        break;
-    case MachineType::Gunner:
-        perform_gunner_attack(attack);
-        break;
-    case MachineType::Melee:
-        perform_melee_attack(attack);
+    case ActionType::EndTurn:
+        end_turn();
         break;
-    case MachineType::Pull:
-        perform_pull_attack(attack);
+    case ActionType::Rotate:
+        board->machine_at(action.source)->direction = action.direction;
         break;
-    case MachineType::Ram:
-        perform_ram_attack(attack);
+    case ActionType::Move:
+    {
+        auto machine = board->machine_at(action.source);
+        Move move(action.destination, 0, action.source, move_causes_state(machine, action.sprint, action.overcharge), false);
+        make_move(move);
         break;
-    case MachineType::Swoop:
-        perform_swoop_attack(attack);
+    }
+    case ActionType::Attack:
+    {
+        auto attacks = calculate_attacks(board->machine_at(action.source));
+        auto attack = std::find_if(attacks.begin(), attacks.end(), [&action](const Attack &a)
+                                   { return action.matches(a); });
+        if (attack == attacks.end())
+            throw std::runtime_error("No attack matches " + action.to_string());
+
+        make_attack(*attack);
         break;
     }
+    }
+}
 
-    attacker->machine_state = attack.causes_state;
-    if (attacker->machine_state == MachineState::Overcharged)
-        modify_machine_health(attacker, -2);
+bool Game::is_legal_action(const Action &action)
+{
+    if (action.type == ActionType::EndTurn)
+        return can_end_turn() || !has_legal_move_or_attack(); // A side with nothing left to do may pass.
+
+    if (action.source.out_of_bounds())
+        return false;
+
+    auto machine = board->machine_at(action.source);
+    if (machine == nullptr || machine->side != turn)
+        return false;
+
+    switch (action.type)
+    {
+    case ActionType::Rotate:
+        return true;
+    case ActionType::Move:
+    {
+        auto moves = calculate_moves(machine);
+        return std::any_of(moves.begin(), moves.end(), [&action](const Move &m)
+                           { return action.matches(m); });
+    }
+    default:
+    {
+        auto attacks = calculate_attacks(machine);
+        return std::any_of(attacks.begin(), attacks.end(), [&action](const Attack &a)
+                           { return action.matches(a); });
+    }
+    }
+}
+
+bool Game::has_legal_move_or_attack()
+{
+    for (auto machine : turn == Player::Player ? player_machines : opponent_machines)
+    {
+        if (machine->is_alive() && (!calculate_attacks(machine).empty() || !calculate_moves(machine).empty()))
+            return true;
+    }
+
+    return false;
+}
+
+// Calls f with the machine on each of the spaces, in the same row major order as iterating the board.
+template <typename F>
+static void for_each_machine_on(Board &board, uint64_t spaces, F f)
+{
+    for (; spaces != 0; spaces &= spaces - 1)
+    {
+        auto space = std::countr_zero(spaces);
+        f(board.machines[{space / 8, space % 8}]);
+    }
 }
 
 void Game::pre_turn()
 {
+    TRACE_ZONE("pre_turn");
+
     state = GameState::TouchFirstMachine;
     for (auto &machine : *board)
     {
@@ -134,59 +225,30 @@ void Game::pre_turn()
         machine->attack_power_modifier = 0;
     }
     
+#ifdef MACHINE_STRIKE_CHECK_THREAT_MAPS
+    verify_threat_maps();
+#endif
+
     for (auto &machine : *board)
     {
-        switch (machine->machine.get().skill)
+        // Only the machines standing in range can be affected. A machine never has its own space in range.
+        auto in_range = spaces_in_attack_range(machine) & board->occupied_mask;
+        auto own_side = board->side_masks[static_cast<int32_t>(machine->side)];
+        switch (MACHINE_TABLE.skill[machine->id])
         {
         case MachineSkill::Spray:
-        {
-            for (auto &other_machine : *board)
-            {
-                if (machine == other_machine)
-                    continue;
-
-                if (is_in_attack_range(machine, other_machine))
-                    modify_machine_health(other_machine, -1);
-            }
+            for_each_machine_on(*board, in_range, [&](GameMachine *other_machine) { modify_machine_health(other_machine, -1); });
             break;
-        }
         case MachineSkill::Whiplash:
-        {
-            for (auto &other_machine : *board)
-            {
-                if (machine == other_machine)
-                    continue;
-
-                if (is_in_attack_range(machine, other_machine))
-                    other_machine->direction = opposite_direction(other_machine->direction);
-            }
+            for_each_machine_on(*board, in_range, [](GameMachine *other_machine) { other_machine->direction = opposite_direction(other_machine->direction); });
             break;
-        }
         case MachineSkill::Empower:
-        {
-            for (auto &other_machine : *board)
-            {
-                if (machine == other_machine || other_machine->side != machine->side)
-                    continue;
-
-                if (is_in_attack_range(machine, other_machine))
-                    ++other_machine->attack_power_modifier;
-            }
+            for_each_machine_on(*board, in_range & own_side, [](GameMachine *other_machine) { ++other_machine->attack_power_modifier; });
             break;
-        }
         case MachineSkill::Blind:
-        {
-            for (auto &other_machine : *board)
-            {
-                if (machine == other_machine || other_machine->side == machine->side)
-                    continue;
-
-                if (is_in_attack_range(machine, other_machine))
-                    --other_machine->attack_power_modifier;
-            }
+            for_each_machine_on(*board, in_range & ~own_side, [](GameMachine *other_machine) { --other_machine->attack_power_modifier; });
             break;
         }
-        }
     }
 }
 
@@ -199,11 +261,11 @@ void Game::modify_machine_health(GameMachine *machine, int32_t health_change)
 
         if (machine->side == Player::Player)
         {
-            opponent_victory_points += machine->machine.get().points;
+            opponent_victory_points += MACHINE_TABLE.points[machine->id];
         }
         else
         {
-            player_victory_points += machine->machine.get().points;
+            player_victory_points += MACHINE_TABLE.points[machine->id];
         }
     }
 }
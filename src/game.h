@@ -3,12 +3,16 @@
 #include <vector>
 #include <functional>
 #include <optional>
+#include <utility>
 #include "move.h"
 #include "game_machine.h"
 #include "enums.h"
 #include "types.h"
 #include "board.h"
 #include "attack.h"
+#include "attack_prediction.h"
+#include "action.h"
+#include "search.h"
 
 class Game
 {
@@ -18,7 +22,7 @@ public:
     int player_victory_points = 0;
     int opponent_victory_points = 0;
     GameState state = GameState::TouchFirstMachine;
-    GameMachine *last_touched_machine;
+    GameMachine *last_touched_machine = nullptr;
     bool must_move_last_touched_machine = false;
     std::vector<GameMachine*> player_machines;
     std::vector<GameMachine*> opponent_machines;
@@ -30,17 +34,42 @@ public:
     Winner check_winner();
     void end_turn();
     bool can_end_turn() const;
+    uint64_t hash() const;
+    // The hash of either the position or its left-right mirror, whichever is lower, and whether it was the mirror.
+    // A position holding a machine that does not play the same when mirrored always hashes as itself.
+    std::pair<uint64_t, bool> canonical_hash() const;
     void print_board(GameMachine* focus_machine = nullptr, std::optional<std::vector<Move>> moves = std::nullopt, std::optional<std::vector<Attack>> attacks = std::nullopt);
     std::vector<Move> calculate_moves(GameMachine *machine);
     std::vector<Attack> calculate_attacks(GameMachine *machine);
     void make_attack(Attack &attack);
     void make_move(Move &m);
-    void search(uint32_t seconds);
+    void make_action(const Action &action);
+    bool is_legal_action(const Action &action);
+    bool has_legal_move_or_attack();
+    // The living machines of the side to move. A side down to one machine may touch it twice in a turn.
+    int get_turn_machine_count() const;
+    // What making the attack would do, worked out without changing the game. Matches make_attack exactly.
+    AttackPrediction predict_attack(const Attack &attack) const;
+    // The attacker's combat power less that of the first machine in its path, both as they stand before the attack.
+    // The attack must affect a machine.
+    int32_t combat_power_margin(const Attack &attack) const;
+    SearchResult search(const SearchConfig &config);
+
+    // Threat queries, answered from masks the board keeps up to date as machines move and die. Each is a bit per space
+    // (1 << (row * 8 + column)). Debug builds check the masks against a full recompute on every query.
+    // The spaces any of the side's machines have in attack range, whether or not anything stands there.
+    uint64_t threatened_spaces(Player side) const;
+    // The spaces of the machines, of either or of one side, that have the space in attack range.
+    uint64_t attackers_of(Coord coordinates) const;
+    uint64_t attackers_of(Coord coordinates, Player side) const;
+    // The spaces the machine has in attack range from where it stands.
+    uint64_t spaces_in_attack_range(const GameMachine *machine) const;
+    // Throws std::logic_error if the board's masks disagree with is_in_attack_range.
+    void verify_threat_maps() const;
 
 private:
 
     // Gameplay
-    int get_turn_machine_count() const;
     void perform_dash_attack(Attack &attack);
     void perform_gunner_attack(Attack &attack);
     void perform_melee_attack(Attack &attack);
@@ -50,19 +79,30 @@ private:
     bool knock_machine(GameMachine *machine, MachineDirection direction);
     void perform_post_attack_skills(GameMachine *attacker, GameMachine *defender, Attack &attack);
     void pre_turn();
+    // Specialised per attacker type: only rams skip knocking a defender back after a defense break.
+    template <MachineType Type>
     void apply_attack(Attack &attack, GameMachine *attacker, uint32_t attacker_combat_power);
+    template <MachineType Type>
     GameMachine* pre_apply_attack(Attack &attack);
     void modify_machine_health(GameMachine* machine, int32_t health_change);
 
     // Attack generation
+    using AttackGenerator = void (Game::*)(GameMachine *machine, std::vector<Attack> &attacks);
+    static AttackGenerator attack_generator(MachineType type, bool sweep);
+    template <MachineType Type, bool Sweep>
+    void generate_attacks(GameMachine *machine, std::vector<Attack> &attacks);
+    // Only called for machines with the sweep skill.
     void populate_adjacent_attacks(GameMachine *machine, MachineDirection direction, Coord source_coodinates, std::optional<std::pair<std::optional<Attack>, std::optional<Attack>>> &attack, std::vector<Coord> &affected_machines);
+    template <bool Sweep>
     std::optional<std::pair<std::optional<Attack>, std::optional<Attack>>> first_machine_in_attack_range(MachineDirection direction, GameMachine *machine);
-    int32_t get_skill_combat_power_modifier_when_defending(GameMachine *machine);
-    int32_t get_skill_combat_power_modifier_when_attacking(GameMachine *machine);
+    int32_t get_skill_combat_power_modifier_when_defending(const GameMachine *machine) const;
+    int32_t get_skill_combat_power_modifier_when_attacking(const GameMachine *machine, Coord coordinates) const;
     int32_t calculate_combat_power(GameMachine *machine, std::optional<MachineDirection> attack_direction);
-    bool is_in_attack_range(GameMachine *attacker, GameMachine *defender);
+    int32_t calculate_combat_power(const GameMachine *machine, Coord coordinates, MachineDirection facing, std::optional<MachineDirection> attack_direction) const;
+    bool is_in_attack_range(const GameMachine *attacker, Coord coordinates) const;
 
     // Move generation
+    MachineState move_causes_state(GameMachine *machine, bool requires_sprint, bool overcharge) const;
     inline SpotState is_spot_blocked_or_redundant(Coord coord, GameMachine *machine, BoardType<bool> &visited);
     std::vector<Move> expand_moves(int32_t distance_travelled, Coord coord, GameMachine *machine, BoardType<bool> &visited);
 };
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <array>
 #include <vector>
 #include <cstdint>
 #include <optional>
@@ -5,7 +6,9 @@
 #include "enums.h"
 #include "game_machine.h"
 #include "attack.h"
+#include "machine_table.h"
 #include "utils.h"
+#include "trace.h"
 
 // TODO: Refactor the crap out of this file.
 
@@ -22,10 +25,6 @@ MachineState attack_causes_state(GameMachine *machine)
 
 void Game::populate_adjacent_attacks(GameMachine *machine, MachineDirection direction, Coord source_coodinates, std::optional<std::pair<std::optional<Attack>, std::optional<Attack>>> &attack, std::vector<Coord> &affected_machines)
 {
-    // If we do not posses the sweep skill, stop.
-    if (machine->machine.get().skill != MachineSkill::Sweep)
-        return;
-
     // Look to the left and right of the destination.
     for (auto sweep_direction : {
              rotate_direction(direction, Rotation::Clockwise),
@@ -77,19 +76,19 @@ void Game::populate_adjacent_attacks(GameMachine *machine, MachineDirection dire
     }
 }
 
+template <bool Sweep>
 std::optional<std::pair<std::optional<Attack>, std::optional<Attack>>> Game::first_machine_in_attack_range(MachineDirection direction, GameMachine *machine)
 {
     std::vector<Coord> affected_machines;
     std::optional<std::pair<std::optional<Attack>, std::optional<Attack>>> attack;
 
-    for (int i = 0; i < machine->machine.get().range && !attack.has_value(); ++i)
+    // Walk the spaces in the direction, stopping at the end of the attack range or the edge of the board.
+    auto square = machine->coordinates.row * 8 + machine->coordinates.column;
+    const auto &ray = MACHINE_TABLE.rays[square][static_cast<int32_t>(direction)];
+    auto reach = MACHINE_TABLE.reach(machine->id, square, direction);
+    for (int i = 0; i < reach && !attack.has_value(); ++i)
     {
-        // Move one space in the direction.
-        auto destination = traverse_direction(machine->coordinates, direction, i + 1);
-
-        // If the destination is out of bounds, stop.
-        if (destination.out_of_bounds())
-            break;
+        Coord destination(ray.squares[i] / 8, ray.squares[i] % 8);
 
         // Is the destination occupied by an enemy machine?
         auto destination_machine = board->machine_at(destination);
@@ -118,7 +117,8 @@ std::optional<std::pair<std::optional<Attack>, std::optional<Attack>>> Game::fir
             affected_machines.push_back(destination);
         }
 
-        populate_adjacent_attacks(machine, direction, destination, attack, affected_machines);
+        if constexpr (Sweep)
+            populate_adjacent_attacks(machine, direction, destination, attack, affected_machines);
     }
 
     if (attack.has_value())
@@ -132,19 +132,12 @@ std::optional<std::pair<std::optional<Attack>, std::optional<Attack>>> Game::fir
     return attack;
 }
 
-std::vector<Attack> Game::calculate_attacks(GameMachine *machine)
+// Gunners only look at the end of their attack range, dashers also need an empty space to land on there, and every other
+// type attacks the first enemy in range. Each combination of type and sweep gets its own copy of the loop so that none of
+// it branches on what kind of machine is attacking.
+template <MachineType Type, bool Sweep>
+void Game::generate_attacks(GameMachine *machine, std::vector<Attack> &attacks)
 {
-    std::vector<Attack> attacks;
-
-    if (machine->side != turn) // If it's not our turn, we can't attack
-        return attacks;
-
-    if (must_move_last_touched_machine) // If we must move the last touched machine, we can't attack
-        return attacks;
-
-    if (machine->machine_state == MachineState::Overcharged && (get_turn_machine_count() > 1 || state == GameState::MustEndTurn))
-        return attacks;
-
     for (auto direction : {
              MachineDirection::North,
              MachineDirection::East,
@@ -152,29 +145,11 @@ std::vector<Attack> Game::calculate_attacks(GameMachine *machine)
              MachineDirection::West,
          })
     {
-        switch (machine->machine.get().machine_type)
-        {
-        case MachineType::Melee:
-        case MachineType::Ram:
-        case MachineType::Swoop:
-        case MachineType::Pull:
-        {
-            auto attack = first_machine_in_attack_range(direction, machine);
-            if (attack.has_value())
-            {
-                if (attack.value().first.has_value())
-                    attacks.push_back(attack.value().first.value());
-                if (attack.value().second.has_value())
-                    attacks.push_back(attack.value().second.value());
-            }
-
-            break;
-        }
-        case MachineType::Gunner:
+        if constexpr (Type == MachineType::Gunner)
         {
             std::vector<Coord> affected_machines;
             std::optional<std::pair<std::optional<Attack>, std::optional<Attack>>> main_attack;
-            auto end_of_attack_range = traverse_direction(machine->coordinates, direction, machine->machine.get().range);
+            auto end_of_attack_range = traverse_direction(machine->coordinates, direction, MACHINE_TABLE.range[machine->id]);
             if (end_of_attack_range.out_of_bounds())
                 continue;
 
@@ -204,7 +179,8 @@ std::vector<Attack> Game::calculate_attacks(GameMachine *machine)
                 affected_machines.push_back(end_of_attack_range);
             }
 
-            populate_adjacent_attacks(machine, direction, end_of_attack_range, main_attack, affected_machines);
+            if constexpr (Sweep)
+                populate_adjacent_attacks(machine, direction, end_of_attack_range, main_attack, affected_machines);
 
             if (main_attack.has_value())
             {
@@ -220,12 +196,10 @@ std::vector<Attack> Game::calculate_attacks(GameMachine *machine)
                     attacks.push_back(main_attack.value().second.value());
                 }
             }
-
-            break;
         }
-        case MachineType::Dash:
+        else if constexpr (Type == MachineType::Dash)
         {
-            auto end_of_attack_range = traverse_direction(machine->coordinates, direction, machine->machine.get().range);
+            auto end_of_attack_range = traverse_direction(machine->coordinates, direction, MACHINE_TABLE.range[machine->id]);
             if (end_of_attack_range.out_of_bounds())
                 continue;
 
@@ -238,7 +212,7 @@ std::vector<Attack> Game::calculate_attacks(GameMachine *machine)
             // we'd have to loop over all the spaces in the path and consider all the adjacent machines in the path.
             // However, because there are no dash machines with the sweep skill that have an attack range greater than 2,
             // we can just grab the first enemy in the path and it should have all the information we need.
-            auto first_enemy_in_path = first_machine_in_attack_range(direction, machine);
+            auto first_enemy_in_path = first_machine_in_attack_range<Sweep>(direction, machine);
             if (first_enemy_in_path.has_value())
             {
                 // The source and affected machines should already be what we want them to be.
@@ -254,15 +228,58 @@ std::vector<Attack> Game::calculate_attacks(GameMachine *machine)
                 }
             }
         }
+        else
+        {
+            auto attack = first_machine_in_attack_range<Sweep>(direction, machine);
+            if (attack.has_value())
+            {
+                if (attack.value().first.has_value())
+                    attacks.push_back(attack.value().first.value());
+                if (attack.value().second.has_value())
+                    attacks.push_back(attack.value().second.value());
+            }
         }
     }
+}
+
+Game::AttackGenerator Game::attack_generator(MachineType type, bool sweep)
+{
+    // Indexed by machine type, in the order MachineType declares them, then by whether the machine has the sweep skill.
+    static constexpr std::array<std::array<AttackGenerator, 2>, 6> generators = {{
+        {&Game::generate_attacks<MachineType::Gunner, false>, &Game::generate_attacks<MachineType::Gunner, true>},
+        {&Game::generate_attacks<MachineType::Pull, false>, &Game::generate_attacks<MachineType::Pull, true>},
+        {&Game::generate_attacks<MachineType::Ram, false>, &Game::generate_attacks<MachineType::Ram, true>},
+        {&Game::generate_attacks<MachineType::Melee, false>, &Game::generate_attacks<MachineType::Melee, true>},
+        {&Game::generate_attacks<MachineType::Dash, false>, &Game::generate_attacks<MachineType::Dash, true>},
+        {&Game::generate_attacks<MachineType::Swoop, false>, &Game::generate_attacks<MachineType::Swoop, true>},
+    }};
+
+    return generators[static_cast<int32_t>(type)][sweep ? 1 : 0];
+}
+
+std::vector<Attack> Game::calculate_attacks(GameMachine *machine)
+{
+    TRACE_ZONE("calculate_attacks");
+
+    std::vector<Attack> attacks;
+
+    if (machine->side != turn) // If it's not our turn, we can't attack
+        return attacks;
+
+    if (must_move_last_touched_machine) // If we must move the last touched machine, we can't attack
+        return attacks;
 
+    if (machine->machine_state == MachineState::Overcharged && (get_turn_machine_count() > 1 || state == GameState::MustEndTurn))
+        return attacks;
+
+    auto generator = attack_generator(MACHINE_TABLE.machine_type[machine->id], MACHINE_TABLE.skill[machine->id] == MachineSkill::Sweep);
+    (this->*generator)(machine, attacks);
     return attacks;
 }
 
-int32_t Game::get_skill_combat_power_modifier_when_defending(GameMachine *machine)
+int32_t Game::get_skill_combat_power_modifier_when_defending(const GameMachine *machine) const
 {
-    switch (machine->machine.get().skill)
+    switch (MACHINE_TABLE.skill[machine->id])
     {
     case MachineSkill::Shield:
         return 1;
@@ -271,25 +288,25 @@ int32_t Game::get_skill_combat_power_modifier_when_defending(GameMachine *machin
     }
 }
 
-int32_t Game::get_skill_combat_power_modifier_when_attacking(GameMachine *machine)
+int32_t Game::get_skill_combat_power_modifier_when_attacking(const GameMachine *machine, Coord coordinates) const
 {
     int32_t combat_power = 0;
-    switch (machine->machine.get().skill)
+    switch (MACHINE_TABLE.skill[machine->id])
     {
     case MachineSkill::Gallop:
-        if (board->terrain_at(machine->coordinates) == Terrain::Grassland)
+        if (board->terrain_at(coordinates) == Terrain::Grassland)
             combat_power = 1;
         break;
     case MachineSkill::Stalk:
-        if (board->terrain_at(machine->coordinates) == Terrain::Forest)
+        if (board->terrain_at(coordinates) == Terrain::Forest)
             combat_power = 1;
         break;
     case MachineSkill::HighGround:
-        if (board->terrain_at(machine->coordinates) == Terrain::Mountain)
+        if (board->terrain_at(coordinates) == Terrain::Mountain)
             combat_power = 1;
         break;
     case MachineSkill::Climb:
-        if (board->terrain_at(machine->coordinates) == Terrain::Hill)
+        if (board->terrain_at(coordinates) == Terrain::Hill)
             combat_power = 1;
         break;
     default:
@@ -301,55 +318,63 @@ int32_t Game::get_skill_combat_power_modifier_when_attacking(GameMachine *machin
 
 // If the second argument is std::nullopt, then a machine's armor will be ignored from the calculation (should only be used for printing the board).
 int32_t Game::calculate_combat_power(GameMachine *machine, std::optional<MachineDirection> attack_direction)
+{
+    return calculate_combat_power(machine, machine->coordinates, machine->direction, attack_direction);
+}
+
+// As above, for the machine standing on the given space with the given facing.
+int32_t Game::calculate_combat_power(const GameMachine *machine, Coord coordinates, MachineDirection facing, std::optional<MachineDirection> attack_direction) const
 {
     // A defending machine's combat power is only the terrain it is standing on, plus any modifiers.
     // An attacking machine's combat power is the terrain it is standing on, plus any modifiers, plus its attack power.
-    int32_t combat_power = static_cast<int32_t>(board->terrain_at(machine->coordinates));
+    int32_t combat_power = static_cast<int32_t>(board->terrain_at(coordinates));
 
     // If the machine is a pull machine and the terrain is marsh, add 1 combat power.
-    if (machine->machine.get().is_pull() && board->terrain_at(machine->coordinates) == Terrain::Marsh)
+    if (MACHINE_TABLE.pull[machine->id] && board->terrain_at(coordinates) == Terrain::Marsh)
         ++combat_power;
 
     // All swoop machines get +1 combat power.
-    if (machine->machine.get().is_flying())
+    if (MACHINE_TABLE.flying[machine->id])
         ++combat_power;
 
     if (machine->side == turn)
     {
-        combat_power += machine->machine.get().attack;
-        combat_power += get_skill_combat_power_modifier_when_attacking(machine);
+        combat_power += MACHINE_TABLE.attack[machine->id];
+        combat_power += get_skill_combat_power_modifier_when_attacking(machine, coordinates);
         return combat_power;
     }
     else
     {
         if (attack_direction.has_value())
-        {
-            auto side_being_attacked = side_tangent_to_direction(attack_direction.value(), machine->direction);
-            if (static_cast<int32_t>(side_being_attacked & machine->machine.get().armored_sides) != 0)
-                combat_power += 1;
-            else if (static_cast<int32_t>(side_being_attacked & machine->machine.get().weak_sides) != 0)
-                combat_power -= 1;
-        }
+            combat_power += MACHINE_TABLE.side_modifier(machine->id, facing, attack_direction.value());
 
         combat_power += get_skill_combat_power_modifier_when_defending(machine);
         return combat_power;
     }
 }
 
-bool Game::is_in_attack_range(GameMachine *attacker, GameMachine *defender)
+int32_t Game::combat_power_margin(const Attack &attack) const
+{
+    auto attacker = board->machines[attack.source];
+    auto defender = board->machines[attack.affected_machines.front()];
+    return calculate_combat_power(attacker, attacker->coordinates, attacker->direction, attack.attack_direction_from_source) -
+           calculate_combat_power(defender, defender->coordinates, defender->direction, attack.attack_direction_from_source);
+}
+
+bool Game::is_in_attack_range(const GameMachine *attacker, Coord coordinates) const
 {
-    // Both the attacker and the defender must be on either the same row or the same column.
-    if (attacker->coordinates.row != defender->coordinates.row && attacker->coordinates.column != defender->coordinates.column)
+    // The attacker and the space must be on either the same row or the same column.
+    if (attacker->coordinates.row != coordinates.row && attacker->coordinates.column != coordinates.column)
         return false;
 
-    // Get the direction from the attacker to the defender.
-    auto direction = get_direction(attacker->coordinates, defender->coordinates);
+    // Get the direction from the attacker to the space.
+    auto direction = get_direction(attacker->coordinates, coordinates);
 
-    // See if the defender is on the attack path of the attacker.
-    for (int i = 1; i < attacker->machine.get().range; ++i)
+    // See if the space is on the attack path of the attacker.
+    for (int i = 1; i < MACHINE_TABLE.range[attacker->id]; ++i)
     {
         auto coord = traverse_direction(attacker->coordinates, direction, i);
-        if (coord == defender->coordinates)
+        if (coord == coordinates)
             return true;
     }
 
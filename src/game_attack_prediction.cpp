@@ -0,0 +1,152 @@
+#include <algorithm>
+#include "game.h"
+#include "attack_prediction.h"
+#include "machine_table.h"
+#include "utils.h"
+
+// The board as an attack leaves it, built up one change at a time. Each helper mirrors the Game function of the same name
+// in game.cpp, game_attacks.cpp and board.cpp, quirks and all, so that predictions match make_attack exactly.
+class AttackScratch
+{
+public:
+    BoardType<GameMachine *> machines;
+    AttackPrediction &prediction;
+
+    AttackScratch(const BoardType<GameMachine *> &machines, AttackPrediction &prediction) : machines(machines), prediction(prediction) {}
+
+    PredictedMachine &state(GameMachine *machine)
+    {
+        for (auto &predicted : prediction.machines)
+        {
+            if (predicted.machine == machine)
+                return predicted;
+        }
+
+        return prediction.machines.emplace_back(PredictedMachine{machine, machine->coordinates, machine->health, machine->direction});
+    }
+
+    void move_machine(Coord source, Coord destination)
+    {
+        if (!machines[source] || machines[destination])
+            return;
+
+        machines[destination] = machines[source];
+        machines[source] = nullptr;
+        state(machines[destination]).coordinates = destination;
+    }
+
+    void modify_machine_health(GameMachine *machine, int32_t health_change)
+    {
+        auto &predicted = state(machine);
+        predicted.health += health_change;
+        if (!predicted.killed())
+            return;
+
+        machines[predicted.coordinates] = nullptr;
+        if (machine->side == Player::Player)
+            prediction.opponent_victory_points += MACHINE_TABLE.points[machine->id];
+        else
+            prediction.player_victory_points += MACHINE_TABLE.points[machine->id];
+    }
+
+    void knock_machine(GameMachine *machine, MachineDirection direction)
+    {
+        auto moved_to = traverse_direction(state(machine).coordinates, direction);
+        if (moved_to.out_of_bounds())
+        {
+            modify_machine_health(machine, -1);
+            return;
+        }
+
+        if (machines[moved_to])
+        {
+            modify_machine_health(machine, -1);
+            modify_machine_health(machines[moved_to], -1);
+            return;
+        }
+
+        move_machine(state(machine).coordinates, moved_to);
+    }
+};
+
+AttackPrediction Game::predict_attack(const Attack &attack) const
+{
+    AttackPrediction prediction;
+    AttackScratch scratch(board->machines, prediction);
+
+    auto attacker = board->machine_at(attack.source);
+    scratch.state(attacker).direction = attack.attack_direction_from_source;
+    auto type = MACHINE_TABLE.machine_type[attacker->id];
+
+    // Kept unsigned like apply_attack's parameter, since that decides how negative combat powers compare.
+    uint32_t attacker_combat_power = calculate_combat_power(attacker, attacker->coordinates, attack.attack_direction_from_source, attack.attack_direction_from_source);
+
+    if (type == MachineType::Dash)
+        scratch.move_machine(attack.source, attack.destination);
+
+    for (const auto &coord : attack.affected_machines)
+    {
+        if (scratch.state(attacker).killed())
+            break;
+
+        auto defender = scratch.machines[coord];
+        if (defender == nullptr)
+            continue;
+
+        const auto &defender_state = scratch.state(defender);
+        auto defender_combat_power = calculate_combat_power(defender, defender_state.coordinates, defender_state.direction, attack.attack_direction_from_source);
+
+        if (defender->side == attacker->side)
+        {
+            auto resulting_defender_combat_power = std::max(defender_combat_power - MACHINE_TABLE.attack[attacker->id], 0);
+            scratch.modify_machine_health(defender, -(attacker_combat_power - resulting_defender_combat_power));
+        }
+        // Deliberately compared as unsigned, the way apply_attack compares them, so that the prediction matches it exactly.
+        else if (attacker_combat_power <= static_cast<uint32_t>(defender_combat_power))
+        {
+            ++prediction.defense_breaks;
+            scratch.modify_machine_health(attacker, -1);
+            scratch.modify_machine_health(defender, -1);
+
+            if (type != MachineType::Ram)
+                scratch.knock_machine(defender, attack.attack_direction_from_source);
+        }
+        else
+        {
+            scratch.modify_machine_health(defender, -(attacker_combat_power - defender_combat_power));
+        }
+    }
+
+    switch (type)
+    {
+    case MachineType::Pull:
+        for (const auto &coord : attack.affected_machines)
+        {
+            if (scratch.machines[coord] != nullptr)
+                scratch.knock_machine(scratch.machines[coord], opposite_direction(attack.attack_direction_from_source));
+        }
+        break;
+    case MachineType::Ram:
+        for (const auto &coord : attack.affected_machines)
+        {
+            if (scratch.machines[coord] != nullptr)
+                scratch.knock_machine(scratch.machines[coord], attack.attack_direction_from_source);
+        }
+
+        if (!scratch.machines[attack.destination])
+            scratch.move_machine(attack.source, attack.destination);
+        else
+            scratch.move_machine(attack.source, traverse_direction(attack.destination, opposite_direction(attack.attack_direction_from_source)));
+        break;
+    case MachineType::Swoop:
+        scratch.move_machine(attack.source, traverse_direction(attack.destination, opposite_direction(attack.attack_direction_from_source)));
+        break;
+    default:
+        break;
+    }
+
+    if (attack.causes_state == MachineState::Overcharged)
+        scratch.modify_machine_health(attacker, -2);
+
+    return prediction;
+}
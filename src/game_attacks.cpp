@@ -2,6 +2,8 @@
 #include "game.h"
 #include "attack.h"
 #include "utils.h"
+#include "machine_table.h"
+#include "trace.h"
 
 // Returns true if the machine was knocked one space, false otherwise.
 bool Game::knock_machine(GameMachine *machine, MachineDirection direction)
@@ -27,16 +29,18 @@ bool Game::knock_machine(GameMachine *machine, MachineDirection direction)
     return true;
 }
 
+template <MachineType Type>
 GameMachine *Game::pre_apply_attack(Attack &attack)
 {
     auto attacker = board->machine_at(attack.source);
     auto attacker_combat_power = calculate_combat_power(attacker, attack.attack_direction_from_source);
 
-    apply_attack(attack, attacker, attacker_combat_power);
+    apply_attack<Type>(attack, attacker, attacker_combat_power);
 
     return attacker;
 }
 
+template <MachineType Type>
 void Game::apply_attack(Attack &attack, GameMachine *attacker, uint32_t attacker_combat_power)
 {
     for (const auto &coord : attack.affected_machines)
@@ -44,14 +48,18 @@ void Game::apply_attack(Attack &attack, GameMachine *attacker, uint32_t attacker
         if (!attacker->is_alive())
             return;
 
+        // An earlier defender may have been destroyed by or knocked into this one.
         auto defender = board->machine_at(coord);
+        if (defender == nullptr)
+            continue;
+
         auto defender_combat_power = calculate_combat_power(defender, attack.attack_direction_from_source);
 
         if (defender->side == attacker->side)
         {
             // This is only possible with the sweep skill.
             // TODO check if armored sides have anything to do with this.
-            auto resulting_defender_combat_power = std::max(defender_combat_power - attacker->machine.get().attack, 0);
+            auto resulting_defender_combat_power = std::max(defender_combat_power - MACHINE_TABLE.attack[attacker->id], 0);
             modify_machine_health(defender, -(attacker_combat_power - resulting_defender_combat_power));
         }
         else
@@ -62,7 +70,7 @@ void Game::apply_attack(Attack &attack, GameMachine *attacker, uint32_t attacker
                 modify_machine_health(attacker, -1);
                 modify_machine_health(defender, -1);
 
-                if (attacker->machine.get().machine_type != MachineType::Ram) // Ram attacks only knock the machine once, even if there was a defense break.
+                if constexpr (Type != MachineType::Ram) // Ram attacks only knock the machine once, even if there was a defense break.
                     knock_machine(defender, attack.attack_direction_from_source);
             }
             else
@@ -76,28 +84,36 @@ void Game::apply_attack(Attack &attack, GameMachine *attacker, uint32_t attacker
 
 void Game::perform_dash_attack(Attack &attack)
 {
+    TRACE_ZONE("perform_dash_attack");
+
     auto attacker = board->machine_at(attack.source);
     auto attacker_combat_power = calculate_combat_power(attacker, attack.attack_direction_from_source);
 
     // Move the attacker to the destination immediately.
     board->move_machine(attack.source, attack.destination);
 
-    apply_attack(attack, attacker, attacker_combat_power);
+    apply_attack<MachineType::Dash>(attack, attacker, attacker_combat_power);
 }
 
 void Game::perform_gunner_attack(Attack &attack)
 {
-    pre_apply_attack(attack);
+    TRACE_ZONE("perform_gunner_attack");
+
+    pre_apply_attack<MachineType::Gunner>(attack);
 }
 
 void Game::perform_melee_attack(Attack &attack)
 {
-    pre_apply_attack(attack);
+    TRACE_ZONE("perform_melee_attack");
+
+    pre_apply_attack<MachineType::Melee>(attack);
 }
 
 void Game::perform_pull_attack(Attack &attack)
 {
-    pre_apply_attack(attack);
+    TRACE_ZONE("perform_pull_attack");
+
+    pre_apply_attack<MachineType::Pull>(attack);
 
     // I don't think any pull machines should be able to attack more than one machine at a time.
     // E.G. there are no pull machines with the swoop skill. Because of this, I have no way to confirm
@@ -105,17 +121,21 @@ void Game::perform_pull_attack(Attack &attack)
     for (const auto &coord : attack.affected_machines)
     {
         auto defender = board->machine_at(coord);
-        knock_machine(defender, opposite_direction(attack.attack_direction_from_source));
+        if (defender != nullptr)
+            knock_machine(defender, opposite_direction(attack.attack_direction_from_source));
     }
 }
 
 void Game::perform_ram_attack(Attack &attack)
 {
-    pre_apply_attack(attack);
+    TRACE_ZONE("perform_ram_attack");
+
+    pre_apply_attack<MachineType::Ram>(attack);
     for (const auto &coord : attack.affected_machines)
     {
         auto defender = board->machine_at(coord);
-        knock_machine(defender, attack.attack_direction_from_source);
+        if (defender != nullptr)
+            knock_machine(defender, attack.attack_direction_from_source);
     }
 
     // Can the machine move to destination (the machine should have been knocked back one space)?
@@ -134,7 +154,9 @@ void Game::perform_ram_attack(Attack &attack)
 
 void Game::perform_swoop_attack(Attack &attack)
 {
-    pre_apply_attack(attack);
+    TRACE_ZONE("perform_swoop_attack");
+
+    pre_apply_attack<MachineType::Swoop>(attack);
 
     // The attacker moves next to the defender along the attack path.
     auto destination = traverse_direction(attack.destination, opposite_direction(attack.attack_direction_from_source));
@@ -143,33 +165,39 @@ void Game::perform_swoop_attack(Attack &attack)
 
 void Game::perform_post_attack_skills(GameMachine *attacker, GameMachine *defender, Attack &attack)
 {
-    switch (attacker->machine.get().skill)
+    switch (MACHINE_TABLE.skill[attacker->id])
     {
     case MachineSkill::AlterTerrain:
-        --board->terrain_at(attack.source);
+    {
+        auto lowered = board->terrain_at(attack.source);
+        board->set_terrain(attack.source, --lowered);
         for (const auto &coord : attack.affected_machines)
-            ++board->terrain_at(coord);
+        {
+            auto raised = board->terrain_at(coord);
+            board->set_terrain(coord, ++raised);
+        }
 
         break;
+    }
     case MachineSkill::Burn:
         for (const auto &coord : attack.affected_machines)
         {
             if (board->terrain_at(coord) == Terrain::Forest)
-                board->terrain_at(coord) = Terrain::Grassland;
+                board->set_terrain(coord, Terrain::Grassland);
         }
         break;
     case MachineSkill::Freeze:
         for (const auto &coord : attack.affected_machines)
         {
             if (board->terrain_at(coord) == Terrain::Marsh)
-                board->terrain_at(coord) = Terrain::Grassland;
+                board->set_terrain(coord, Terrain::Grassland);
         }
         break;
     case MachineSkill::Growth:
         for (const auto &coord : attack.affected_machines)
         {
             if (board->terrain_at(coord) == Terrain::Grassland)
-                board->terrain_at(coord) = Terrain::Forest;
+                board->set_terrain(coord, Terrain::Forest);
         }
         break;
     }
@@ -177,14 +205,14 @@ void Game::perform_post_attack_skills(GameMachine *attacker, GameMachine *defend
     for (const auto &coord : attack.affected_machines)
     {
         auto machine = board->machine_at(coord);
-        if (machine->machine.get().skill != MachineSkill::Retaliate)
+        if (MACHINE_TABLE.skill[machine->id] != MachineSkill::Retaliate)
             continue;
 
         // Rotate the machine towards the attacker
         machine->direction = opposite_direction(attack.attack_direction_from_source);
 
         // Traverse the attack range of the defender and see if the attacker is within range.
-        for (int i = 1; i <= machine->machine.get().range; i++)
+        for (int i = 1; i <= MACHINE_TABLE.range[machine->id]; i++)
         {
             auto new_coord = traverse_direction(coord, machine->direction, i);
             if (new_coord == attacker->coordinates)
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include "game.h"
+#include "machine_definitions.h"
+#include "machine_table.h"
+#include "utils.h"
+#include "zobrist.h"
+
+// Hashes the position, or the position reflected across the board's vertical axis if mirror is set.
+static uint64_t position_hash(const Game &game, bool mirror)
+{
+    // The board keeps the unmirrored terrain's share of the hash up to date itself.
+    uint64_t hash = mirror ? 0 : game.board->terrain->hash;
+    if (mirror)
+    {
+        for (int row = 0; row < 8; ++row)
+        {
+            for (int column = 0; column < 8; ++column)
+                hash ^= ZOBRIST.terrain[row * 8 + 7 - column][static_cast<int32_t>(game.board->terrain->spaces.data[row][column]) - static_cast<int32_t>(Terrain::Chasm)];
+        }
+    }
+
+    // Walking the machine lists is quicker than the board. Dead machines stay in the lists but are off the board.
+    for (const auto *machines : {&game.player_machines, &game.opponent_machines})
+    {
+        for (auto machine : *machines)
+        {
+            auto coordinates = machine->coordinates;
+            if (game.board->machines.data[coordinates.row][coordinates.column] != machine)
+                continue;
+
+            auto space = coordinates.row * 8 + (mirror ? 7 - coordinates.column : coordinates.column);
+            auto direction = mirror ? mirror_direction(machine->direction) : machine->direction;
+            hash ^= ZOBRIST.machine_id[space][machine->id & 63];
+            hash ^= ZOBRIST.direction[space][static_cast<int32_t>(direction)];
+            hash ^= ZOBRIST.side[space][static_cast<int32_t>(machine->side)];
+            hash ^= ZOBRIST.health[space][std::clamp(machine->health, 0, 15)];
+            hash ^= ZOBRIST.machine_state[space][static_cast<int32_t>(machine->machine_state)];
+            hash ^= ZOBRIST.attack_power_modifier[space][std::clamp(machine->attack_power_modifier + 8, 0, 15)];
+
+            // The last touched machine only matters while it must be moved.
+            if (game.must_move_last_touched_machine && machine == game.last_touched_machine)
+                hash ^= ZOBRIST.last_touched[space];
+        }
+    }
+
+    if (game.turn == Player::Opponent)
+        hash ^= ZOBRIST.opponent_to_move;
+    if (game.must_move_last_touched_machine)
+        hash ^= ZOBRIST.must_move_last_touched_machine;
+
+    hash ^= ZOBRIST.game_state[static_cast<int32_t>(game.state)];
+    hash ^= ZOBRIST.player_victory_points[std::min(game.player_victory_points, 63)];
+    hash ^= ZOBRIST.opponent_victory_points[std::min(game.opponent_victory_points, 63)];
+
+    return hash;
+}
+
+uint64_t Game::hash() const
+{
+    return position_hash(*this, false);
+}
+
+std::pair<uint64_t, bool> Game::canonical_hash() const
+{
+    auto hash = position_hash(*this, false);
+    for (const auto &row : board->machines.data)
+    {
+        for (auto machine : row)
+        {
+            if (machine != nullptr && !MACHINE_TABLE.mirror_symmetric[machine->id])
+                return {hash, false};
+        }
+    }
+
+    auto mirrored_hash = position_hash(*this, true);
+    return mirrored_hash < hash ? std::make_pair(mirrored_hash, true) : std::make_pair(hash, false);
+}
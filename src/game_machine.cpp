@@ -1,4 +1,6 @@
+#include <stdexcept>
 #include "game_machine.h"
+#include "machine_definitions.h"
 
 GameMachine::GameMachine(
     std::reference_wrapper<const Machine> machine,
@@ -6,11 +8,16 @@ GameMachine::GameMachine(
     Coord coordinates,
     MachineState machine_state,
     Player side) : machine(machine),
+                   id(machine_id(machine.get())),
                    health(machine.get().health),
                    direction(direction),
                    coordinates(coordinates),
                    machine_state(machine_state),
-                   side(side) {}
+                   side(side)
+{
+    if (id < 0)
+        throw std::invalid_argument(std::string("Unknown machine definition ") + machine.get().name);
+}
 
 bool GameMachine::is_alive() const
 {
@@ -10,6 +10,8 @@ class GameMachine
 {
 public:
     std::reference_wrapper<const Machine> machine;
+    // The definition's index in ALL_MACHINES and MACHINE_TABLE.
+    int32_t id;
     int32_t health;
     MachineDirection direction;
     Coord coordinates;
@@ -8,6 +8,9 @@
 #include "board.h"
 #include "coord.h"
 #include "move.h"
+#include "reachability.h"
+#include "machine_table.h"
+#include "trace.h"
 
 inline SpotState Game::is_spot_blocked_or_redundant(Coord coord, GameMachine *machine, BoardType<bool> &visited)
 {
@@ -30,7 +33,7 @@ inline SpotState Game::is_spot_blocked_or_redundant(Coord coord, GameMachine *ma
     }
 
     // Is the machine not a flying machine and is the terrain a chasm?
-    if (!machine->machine.get().is_flying() && board->terrain_at(coord) == Terrain::Chasm)
+    if (!MACHINE_TABLE.flying[machine->id] && board->terrain_at(coord) == Terrain::Chasm)
     {
         return SpotState::BlockedOrRedundant;
     }
@@ -38,21 +41,34 @@ inline SpotState Game::is_spot_blocked_or_redundant(Coord coord, GameMachine *ma
     return SpotState::Empty;
 }
 
+// Returns the state a move leaves the machine in. Moving a machine that has already moved is an overcharge,
+// unless it is the only machine left and is being touched a second time, in which case it moves as if it were fresh.
+MachineState Game::move_causes_state(GameMachine *machine, bool requires_sprint, bool overcharge) const
+{
+    if (overcharge)
+        return MachineState::Overcharged;
+    if (machine->has_moved() || machine->machine_state == MachineState::Overcharged)
+        return requires_sprint ? MachineState::Sprinted : MachineState::Moved;
+    if (machine->has_attacked())
+        return MachineState::MovedAndAttacked;
+    return requires_sprint ? MachineState::Sprinted : MachineState::Moved;
+}
+
 std::vector<Move> Game::expand_moves(int32_t distance_travelled, Coord coord, GameMachine *machine, BoardType<bool> &visited)
 {
     // If we have already sprinted, we can't move
-    if (distance_travelled > machine->machine.get().movement + 1)
+    if (distance_travelled > MACHINE_TABLE.movement[machine->id] + 1)
     {
         return {};
     }
 
     // If this isn't our first movement (not move) and if the machine is not a flying machine and if the machine is not a pull type and we are currently in a marsh, we can't move
-    if (distance_travelled > 1 && !machine->machine.get().is_flying() && !machine->machine.get().is_pull() && board->terrain_at(coord) == Terrain::Marsh)
+    if (distance_travelled > 1 && !MACHINE_TABLE.flying[machine->id] && !MACHINE_TABLE.pull[machine->id] && board->terrain_at(coord) == Terrain::Marsh)
     {
         return {};
     }
 
-    bool requires_sprint = distance_travelled > machine->machine.get().movement;
+    bool requires_sprint = distance_travelled > MACHINE_TABLE.movement[machine->id];
     if (machine->has_attacked() && requires_sprint) // If we have attacked and the move requires a sprint, we can't make this move
         return {};
 
@@ -65,13 +81,10 @@ std::vector<Move> Game::expand_moves(int32_t distance_travelled, Coord coord, Ga
         if (spot_state == SpotState::BlockedOrRedundant)
             continue;
 
-        auto causes_state = machine->has_moved() ? MachineState::Overcharged : machine->has_attacked() ? MachineState::MovedAndAttacked
-                                                                          : requires_sprint          ? MachineState::Sprinted
-                                                                                                     : MachineState::Moved;
         if (machine->machine_state != MachineState::Overcharged)
-            moves.emplace_back(new_coord, distance_travelled, machine->coordinates, causes_state, spot_state == SpotState::Occupied);
+            moves.emplace_back(new_coord, distance_travelled, machine->coordinates, move_causes_state(machine, requires_sprint, machine->has_moved()), spot_state == SpotState::Occupied);
         if (get_turn_machine_count() == 1 && (machine->has_moved() || machine->machine_state == MachineState::Overcharged) && state == GameState::TouchSecondMachine) // If we only have one machine and it has moved and if we haven't already moved two machines, we can move it again as if it were a second machine->
-            moves.emplace_back(new_coord, distance_travelled, machine->coordinates, requires_sprint ? MachineState::Sprinted : MachineState::Moved, spot_state == SpotState::Occupied);
+            moves.emplace_back(new_coord, distance_travelled, machine->coordinates, move_causes_state(machine, requires_sprint, false), spot_state == SpotState::Occupied);
 
         visited[new_coord] = true;
     }
@@ -81,6 +94,8 @@ std::vector<Move> Game::expand_moves(int32_t distance_travelled, Coord coord, Ga
 
 std::vector<Move> Game::calculate_moves(GameMachine *machine)
 {
+    TRACE_ZONE("calculate_moves");
+
     if (machine->side != turn) // If it's not our turn, we can't move
         return {};
 
@@ -95,8 +110,43 @@ std::vector<Move> Game::calculate_moves(GameMachine *machine)
     if (state == GameState::MustEndTurn && !machine->has_moved())
         return {};
 
+    // Machines are passed over rather than around, so where a machine can get to only depends on the terrain, and the
+    // spaces other machines stand on are then left out. The exception is a walker passing over a machine that stands on a
+    // chasm, which takes the full walk below.
+    auto movement_class = MACHINE_TABLE.flying[machine->id] ? MovementClass::Flying : MACHINE_TABLE.pull[machine->id] ? MovementClass::Pull
+                                                                                                                      : MovementClass::Walker;
+    if (movement_class == MovementClass::Flying || (board->occupied_mask & board->terrain->chasm_mask) == 0)
+    {
+        // A machine that has attacked cannot sprint.
+        auto movement = MACHINE_TABLE.movement[machine->id];
+        const auto &reachable = reachable_spaces(*board, machine->coordinates, movement + (machine->has_attacked() ? 0 : 1), movement_class);
+
+        std::vector<Move> moves;
+        if ((reachable.mask & ~board->occupied_mask) == 0)
+            return moves;
+
+        // If we only have one machine and it has moved and if we haven't already moved two machines, we can move it again as if it were a second machine.
+        auto can_move_again = get_turn_machine_count() == 1 && (machine->has_moved() || machine->machine_state == MachineState::Overcharged) && state == GameState::TouchSecondMachine;
+        for (auto [space, distance] : reachable.spaces)
+        {
+            if ((board->occupied_mask >> space) & 1)
+                continue;
+
+            Coord destination(space / 8, space % 8);
+            auto requires_sprint = distance > movement;
+            if (machine->machine_state != MachineState::Overcharged)
+                moves.emplace_back(destination, distance, machine->coordinates, move_causes_state(machine, requires_sprint, machine->has_moved()), false);
+            if (can_move_again)
+                moves.emplace_back(destination, distance, machine->coordinates, move_causes_state(machine, requires_sprint, false), false);
+        }
+
+        return moves;
+    }
+
     BoardType<bool> visited{false};
     auto all_moves = expand_moves(1, machine->coordinates, machine, visited);
+    if (all_moves.empty())
+        return all_moves;
 
     auto expanded_index = 0;
     do
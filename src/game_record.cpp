@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include "game_record.h"
+
+constexpr char RECORD_MAGIC[] = {'M', 'S', 'G', 'R'};
+constexpr uint8_t RECORD_VERSION = 1;
+
+GameRecord::GameRecord(const Game &initial_game) : initial_position(pack_position(initial_game)) {}
+
+void GameRecord::add_action(const Action &action)
+{
+    actions.push_back(action.encode());
+}
+
+std::vector<uint8_t> GameRecord::serialize() const
+{
+    std::vector<uint8_t> bytes(std::begin(RECORD_MAGIC), std::end(RECORD_MAGIC));
+    bytes.push_back(RECORD_VERSION);
+    bytes.push_back(static_cast<uint8_t>(result));
+    bytes.push_back(initial_position.size);
+    bytes.insert(bytes.end(), initial_position.data().begin(), initial_position.data().end());
+
+    auto count = static_cast<uint32_t>(actions.size());
+    for (int i = 0; i < 4; ++i)
+        bytes.push_back(static_cast<uint8_t>(count >> (i * 8)));
+
+    for (auto action : actions)
+    {
+        bytes.push_back(static_cast<uint8_t>(action));
+        bytes.push_back(static_cast<uint8_t>(action >> 8));
+    }
+
+    return bytes;
+}
+
+GameRecord GameRecord::deserialize(std::span<const uint8_t> bytes)
+{
+    if (bytes.size() < 7 || !std::equal(std::begin(RECORD_MAGIC), std::end(RECORD_MAGIC), bytes.begin()))
+        throw std::runtime_error("Not a game record");
+    if (bytes[4] != RECORD_VERSION)
+        throw std::runtime_error("Unsupported game record version");
+    if (bytes[5] > static_cast<uint8_t>(Winner::None))
+        throw std::runtime_error("Invalid game record result");
+
+    GameRecord record;
+    record.result = static_cast<Winner>(bytes[5]);
+    record.initial_position.size = bytes[6];
+
+    size_t offset = 7;
+    if (record.initial_position.size > MAX_PACKED_POSITION_SIZE || bytes.size() < offset + record.initial_position.size + 4)
+        throw std::runtime_error("Truncated game record");
+
+    std::copy_n(bytes.begin() + offset, record.initial_position.size, record.initial_position.bytes.begin());
+    offset += record.initial_position.size;
+
+    uint32_t count = 0;
+    for (int i = 0; i < 4; ++i)
+        count |= static_cast<uint32_t>(bytes[offset++]) << (i * 8);
+
+    if (bytes.size() != offset + static_cast<size_t>(count) * 2)
+        throw std::runtime_error("Truncated game record");
+
+    record.actions.resize(count);
+    for (auto &action : record.actions)
+    {
+        action = static_cast<uint16_t>(bytes[offset] | bytes[offset + 1] << 8);
+        offset += 2;
+    }
+
+    return record;
+}
+
+void GameRecord::save(const std::string &path) const
+{
+    auto bytes = serialize();
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+    if (!file)
+        throw std::runtime_error("Could not write " + path);
+}
+
+GameRecord GameRecord::load(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Could not open " + path);
+
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return deserialize(bytes);
+}
+
+ReplayResult replay_actions(Game &game, const GameRecord &record, bool verify, const ReplayVisitor &visitor)
+{
+    ReplayResult result;
+
+    try
+    {
+        for (auto encoded_action : record.actions)
+        {
+            auto action = Action::decode(encoded_action);
+            if (verify && !game.is_legal_action(action))
+            {
+                result.ok = false;
+                result.error = "Illegal action " + std::to_string(result.actions_applied) + ": " + action.to_string();
+                break;
+            }
+
+            if (visitor)
+                visitor(game, action);
+
+            game.make_action(action);
+            ++result.actions_applied;
+        }
+
+        result.winner = game.check_winner();
+        if (result.ok && verify && result.winner != record.result)
+        {
+            result.ok = false;
+            result.error = "Recorded result does not match the replayed game";
+        }
+    }
+    catch (const std::exception &e)
+    {
+        result.ok = false;
+        result.error = e.what();
+    }
+
+    return result;
+}
+
+ReplayResult replay_record(const GameRecord &record, bool verify, const ReplayVisitor &visitor)
+{
+    try
+    {
+        auto game = unpack_position(record.initial_position);
+        return replay_actions(game, record, verify, visitor);
+    }
+    catch (const std::exception &e)
+    {
+        ReplayResult result;
+        result.ok = false;
+        result.error = e.what();
+        return result;
+    }
+}
+
+BulkReplaySummary replay_directory(const std::string &directory, uint32_t threads, bool verify)
+{
+    std::vector<std::string> paths;
+    for (const auto &entry : std::filesystem::directory_iterator(directory))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".msr")
+            paths.push_back(entry.path().string());
+    }
+
+    std::sort(paths.begin(), paths.end());
+
+    BulkReplaySummary summary;
+    summary.records = paths.size();
+
+    std::mutex summary_mutex;
+    std::atomic<size_t> next_path = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    auto worker = [&]()
+    {
+        size_t actions = 0;
+        for (auto i = next_path++; i < paths.size(); i = next_path++)
+        {
+            ReplayResult result;
+            try
+            {
+                result = replay_record(GameRecord::load(paths[i]), verify);
+            }
+            catch (const std::exception &e)
+            {
+                result.ok = false;
+                result.error = e.what();
+            }
+
+            actions += result.actions_applied;
+            if (!result.ok)
+            {
+                std::lock_guard lock(summary_mutex);
+                ++summary.failed;
+                summary.failures.push_back(paths[i] + ": " + result.error);
+            }
+        }
+
+        std::lock_guard lock(summary_mutex);
+        summary.actions += actions;
+    };
+
+    std::vector<std::thread> workers;
+    for (uint32_t i = 0; i < std::max(threads, 1u); ++i)
+        workers.emplace_back(worker);
+    for (auto &thread : workers)
+        thread.join();
+
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::sort(summary.failures.begin(), summary.failures.end());
+    return summary;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "action.h"
+#include "enums.h"
+#include "game.h"
+#include "position.h"
+
+// A recorded game: the initial position followed by every action taken from it.
+//
+// On disk a record is:
+//   4 bytes  "MSGR"
+//   1 byte   format version
+//   1 byte   result (a Winner)
+//   1 byte   packed position size
+//   n bytes  packed initial position
+//   4 bytes  action count, little-endian
+//   2 bytes  per action, little-endian (see Action::encode)
+class GameRecord
+{
+public:
+    PackedPosition initial_position;
+    std::vector<uint16_t> actions;
+    Winner result = Winner::None;
+
+    GameRecord() = default;
+    GameRecord(const Game &initial_game);
+
+    void add_action(const Action &action);
+
+    std::vector<uint8_t> serialize() const;
+    static GameRecord deserialize(std::span<const uint8_t> bytes);
+
+    void save(const std::string &path) const;
+    static GameRecord load(const std::string &path);
+};
+
+class ReplayResult
+{
+public:
+    bool ok = true;
+    // The number of actions applied before the replay stopped.
+    size_t actions_applied = 0;
+    Winner winner = Winner::None;
+    std::string error;
+};
+
+// Called before each action is applied, with the game in the position the action is played from.
+using ReplayVisitor = std::function<void(Game &game, const Action &action)>;
+
+// Re-simulates a record through Game::make_action. If verify is set, every action is checked against the
+// generated moves and attacks first and the replay stops at the first illegal one.
+ReplayResult replay_record(const GameRecord &record, bool verify, const ReplayVisitor &visitor = nullptr);
+// Same as replay_record, but plays the actions on a game the caller has already set to the record's initial position.
+ReplayResult replay_actions(Game &game, const GameRecord &record, bool verify, const ReplayVisitor &visitor = nullptr);
+
+class BulkReplaySummary
+{
+public:
+    size_t records = 0;
+    size_t failed = 0;
+    size_t actions = 0;
+    double seconds = 0;
+    // One "<path>: <error>" line per failed record.
+    std::vector<std::string> failures;
+};
+
+// Replays every .msr file in a directory, spread over the given number of threads.
+BulkReplaySummary replay_directory(const std::string &directory, uint32_t threads, bool verify);
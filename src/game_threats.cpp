@@ -0,0 +1,106 @@
+#include <array>
+#include <stdexcept>
+#include "game.h"
+#include "machine_table.h"
+
+// A bit in the first column of every row.
+constexpr uint64_t FIRST_COLUMN = 0x0101010101010101;
+
+static uint64_t space_bit(Coord coord)
+{
+    return uint64_t(1) << (coord.row * 8 + coord.column);
+}
+
+// The spaces exactly distance away from any of the spaces along a row or column.
+static uint64_t spaces_at_distance(uint64_t spaces, int32_t distance)
+{
+    auto east = (spaces & (FIRST_COLUMN * (0xFF >> distance))) << distance;
+    auto west = (spaces & (FIRST_COLUMN * ((0xFF << distance) & 0xFF))) >> distance;
+    return east | west | (spaces << (8 * distance)) | (spaces >> (8 * distance));
+}
+
+static uint64_t threatened_spaces_from_masks(const Board &board, Player side)
+{
+    uint64_t threatened = 0;
+    auto side_mask = board.side_masks[static_cast<int32_t>(side)];
+    for (int32_t distance = 1; distance < 8; ++distance)
+        threatened |= spaces_at_distance(board.reach_masks[distance] & side_mask, distance);
+    return threatened;
+}
+
+static uint64_t attackers_from_masks(const Board &board, int32_t space)
+{
+    uint64_t attackers = 0;
+    const auto &cross_masks = MACHINE_TABLE.cross_masks[space];
+    for (int32_t distance = 1; distance < 8; ++distance)
+        attackers |= (cross_masks[distance] ^ cross_masks[distance - 1]) & board.reach_masks[distance];
+    return attackers;
+}
+
+uint64_t Game::threatened_spaces(Player side) const
+{
+#ifdef MACHINE_STRIKE_CHECK_THREAT_MAPS
+    verify_threat_maps();
+#endif
+    return threatened_spaces_from_masks(*board, side);
+}
+
+uint64_t Game::attackers_of(Coord coordinates) const
+{
+#ifdef MACHINE_STRIKE_CHECK_THREAT_MAPS
+    verify_threat_maps();
+#endif
+    return attackers_from_masks(*board, coordinates.row * 8 + coordinates.column);
+}
+
+uint64_t Game::attackers_of(Coord coordinates, Player side) const
+{
+    return attackers_of(coordinates) & board->side_masks[static_cast<int32_t>(side)];
+}
+
+uint64_t Game::spaces_in_attack_range(const GameMachine *machine) const
+{
+    return MACHINE_TABLE.attack_range_mask(machine->id, machine->coordinates.row * 8 + machine->coordinates.column);
+}
+
+void Game::verify_threat_maps() const
+{
+    // Worked out from scratch with is_in_attack_range, the way pre_turn used to.
+    std::array<uint64_t, 2> side_masks{};
+    std::array<uint64_t, 2> threatened{};
+    std::array<uint64_t, 64> attackers{};
+    for (const auto *machines : {&player_machines, &opponent_machines})
+    {
+        for (auto machine : *machines)
+        {
+            if (board->machines[machine->coordinates] != machine)
+                continue;
+
+            side_masks[static_cast<int32_t>(machine->side)] |= space_bit(machine->coordinates);
+            for (int32_t space = 0; space < 64; ++space)
+            {
+                Coord coordinates(space / 8, space % 8);
+                if (coordinates == machine->coordinates || !is_in_attack_range(machine, coordinates))
+                    continue;
+
+                threatened[static_cast<int32_t>(machine->side)] |= space_bit(coordinates);
+                attackers[space] |= space_bit(machine->coordinates);
+            }
+        }
+    }
+
+    if (side_masks != board->side_masks || (side_masks[0] | side_masks[1]) != board->occupied_mask)
+        throw std::logic_error("The board's side masks do not match its machines.");
+
+    for (auto side : {Player::Player, Player::Opponent})
+    {
+        if (threatened_spaces_from_masks(*board, side) != threatened[static_cast<int32_t>(side)])
+            throw std::logic_error("The threatened spaces do not match a full recompute.");
+    }
+
+    for (int32_t space = 0; space < 64; ++space)
+    {
+        if (attackers_from_masks(*board, space) != attackers[space])
+            throw std::logic_error("The attackers of a space do not match a full recompute.");
+    }
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
 #include "enums.h"
+#include "utils.h"
 
 class Machine {
 public:
@@ -15,7 +16,18 @@ public:
     int32_t movement;
     int32_t points;
 
-    Machine(const char* name, MachineType machine_type, MachineSkill skill, int32_t health, int32_t attack, int32_t range, int32_t movement, MachineSide armored_sides, MachineSide weak_sides, int32_t points);
-    bool is_flying() const;
-    bool is_pull() const;
+    constexpr Machine(const char* name, MachineType machine_type, MachineSkill skill, int32_t health, int32_t attack, int32_t range, int32_t movement, MachineSide armored_sides, MachineSide weak_sides, int32_t points)
+        : name(name), skill(skill), machine_type(machine_type), armored_sides(armored_sides), weak_sides(weak_sides), health(health), attack(attack), range(range), movement(movement), points(points)
+    {
+    }
+
+    constexpr bool is_flying() const { return machine_type == MachineType::Swoop; }
+    constexpr bool is_pull() const { return machine_type == MachineType::Pull; }
+    // Whether a mirrored copy of this machine plays the same as it does: its left and right sides match and
+    // it has no start-of-turn skill whose result depends on the order machines are visited in.
+    constexpr bool is_mirror_symmetric() const
+    {
+        return mirror_sides(armored_sides) == armored_sides && mirror_sides(weak_sides) == weak_sides &&
+               skill != MachineSkill::Spray && skill != MachineSkill::Whiplash;
+    }
 };
\ No newline at end of file
@@ -1,11 +1,12 @@
 #pragma once
-#include <memory>
-#include <vector>
+#include <array>
 #include <functional>
+#include <string_view>
+#include <cstdint>
 #include "machine.h"
 #include "enums.h"
 
-const static Machine BEHEMOTH(
+inline constexpr Machine BEHEMOTH(
     "Behemoth",
     MachineType::Gunner,
     MachineSkill::Shield,
@@ -17,7 +18,7 @@ const static Machine BEHEMOTH(
     MachineSide::Left | MachineSide::Right,
     5);
 
-const static Machine BELLOWBACK(
+inline constexpr Machine BELLOWBACK(
     "Bellowback",
     MachineType::Gunner,
     MachineSkill::Spray,
@@ -29,7 +30,7 @@ const static Machine BELLOWBACK(
     MachineSide::Left | MachineSide::Right | MachineSide::Rear,
     3);
 
-const static Machine BILEGUT(
+inline constexpr Machine BILEGUT(
     "Bilegut",
     MachineType::Pull,
     MachineSkill::AlterTerrain,
@@ -41,7 +42,7 @@ const static Machine BILEGUT(
     MachineSide::Front,
     5);
 
-const static Machine BRISTLEBACK(
+inline constexpr Machine BRISTLEBACK(
     "Bristleback",
     MachineType::Ram,
     MachineSkill::Spray,
@@ -53,7 +54,7 @@ const static Machine BRISTLEBACK(
     MachineSide::Rear,
     2);
 
-const static Machine BURROWER(
+inline constexpr Machine BURROWER(
     "Burrower",
     MachineType::Melee,
     MachineSkill::None,
@@ -65,7 +66,7 @@ const static Machine BURROWER(
     MachineSide::Rear,
     1);
 
-const static Machine TRACKERBURROWER(
+inline constexpr Machine TRACKERBURROWER(
     "TrackerBurrower",
     MachineType::Melee,
     MachineSkill::AlterTerrain,
@@ -77,7 +78,7 @@ const static Machine TRACKERBURROWER(
     MachineSide::Rear,
     2);
 
-const static Machine CHARGER(
+inline constexpr Machine CHARGER(
     "Charger",
     MachineType::Dash,
     MachineSkill::Gallop,
@@ -89,7 +90,7 @@ const static Machine CHARGER(
     MachineSide::Rear,
     2);
 
-const static Machine CLAMBERJAW(
+inline constexpr Machine CLAMBERJAW(
     "Clamberjaw",
     MachineType::Melee,
     MachineSkill::Stalk,
@@ -101,7 +102,7 @@ const static Machine CLAMBERJAW(
     MachineSide::Rear,
     4);
 
-const static Machine CLAWSTRIDER(
+inline constexpr Machine CLAWSTRIDER(
     "Clawstrider",
     MachineType::Melee,
     MachineSkill::None,
@@ -113,7 +114,7 @@ const static Machine CLAWSTRIDER(
     MachineSide::Rear,
     3);
 
-const static Machine ELEMENTALCLAWSTRIDER(
+inline constexpr Machine ELEMENTALCLAWSTRIDER(
     "ElementalClawstrider",
     MachineType::Gunner,
     MachineSkill::Burn,
@@ -125,7 +126,7 @@ const static Machine ELEMENTALCLAWSTRIDER(
     MachineSide::Rear,
     4);
 
-const static Machine APEXCLAWSTRIDER(
+inline constexpr Machine APEXCLAWSTRIDER(
     "ApexClawstrider",
     MachineType::Melee,
     MachineSkill::Retaliate,
@@ -137,7 +138,7 @@ const static Machine APEXCLAWSTRIDER(
     MachineSide::Rear,
     5);
 
-const static Machine DREADWING(
+inline constexpr Machine DREADWING(
     "Dreadwing",
     MachineType::Swoop,
     MachineSkill::Whiplash,
@@ -149,7 +150,7 @@ const static Machine DREADWING(
     MachineSide::Rear,
     5);
 
-const static Machine FANGHORN(
+inline constexpr Machine FANGHORN(
     "Fanghorn",
     MachineType::Ram,
     MachineSkill::HighGround,
@@ -161,7 +162,7 @@ const static Machine FANGHORN(
     MachineSide::Left | MachineSide::Right,
     2);
 
-const static Machine FIRECLAW(
+inline constexpr Machine FIRECLAW(
     "Fireclaw",
     MachineType::Melee,
     MachineSkill::Burn,
@@ -173,7 +174,7 @@ const static Machine FIRECLAW(
     MachineSide::Rear,
     7);
 
-const static Machine FROSTCLAW(
+inline constexpr Machine FROSTCLAW(
     "Frostclaw",
     MachineType::Melee,
     MachineSkill::Freeze,
@@ -185,7 +186,7 @@ const static Machine FROSTCLAW(
     MachineSide::Front,
     7);
 
-const static Machine GLINTHAWK(
+inline constexpr Machine GLINTHAWK(
     "Glinthawk",
     MachineType::Swoop,
     MachineSkill::None,
@@ -197,7 +198,7 @@ const static Machine GLINTHAWK(
     MachineSide::Front,
     7);
 
-const static Machine GRAZER(
+inline constexpr Machine GRAZER(
     "Grazer",
     MachineType::Ram,
     MachineSkill::Gallop,
@@ -209,7 +210,7 @@ const static Machine GRAZER(
     MachineSide::Left | MachineSide::Right,
     1);
 
-const static Machine LANCEHORN(
+inline constexpr Machine LANCEHORN(
     "Lancehorn",
     MachineType::Ram,
     MachineSkill::Climb,
@@ -221,7 +222,7 @@ const static Machine LANCEHORN(
     MachineSide::Left | MachineSide::Right,
     2);
 
-const static Machine LEAPLASHER(
+inline constexpr Machine LEAPLASHER(
     "Leaplasher",
     MachineType::Melee,
     MachineSkill::Empower,
@@ -233,7 +234,7 @@ const static Machine LEAPLASHER(
     MachineSide::Rear,
     1);
 
-const static Machine LONGLEG(
+inline constexpr Machine LONGLEG(
     "Longleg",
     MachineType::Gunner,
     MachineSkill::Empower,
@@ -245,7 +246,7 @@ const static Machine LONGLEG(
     MachineSide::Rear,
     2);
 
-const static Machine PLOWHORN(
+inline constexpr Machine PLOWHORN(
     "Plowhorn",
     MachineType::Ram,
     MachineSkill::Growth,
@@ -257,7 +258,7 @@ const static Machine PLOWHORN(
     MachineSide::Rear,
     1);
 
-const static Machine RAVAGER(
+inline constexpr Machine RAVAGER(
     "Ravager",
     MachineType::Gunner,
     MachineSkill::Sweep,
@@ -269,7 +270,7 @@ const static Machine RAVAGER(
     MachineSide::Rear,
     4);
 
-const static Machine REDEYEWATCHER(
+inline constexpr Machine REDEYEWATCHER(
     "RedeyeWatcher",
     MachineType::Gunner,
     MachineSkill::Blind,
@@ -281,7 +282,7 @@ const static Machine REDEYEWATCHER(
     MachineSide::Front,
     3);
 
-const static Machine ROCKBREAKER(
+inline constexpr Machine ROCKBREAKER(
     "Rockbreaker",
     MachineType::Gunner,
     MachineSkill::AlterTerrain,
@@ -293,7 +294,7 @@ const static Machine ROCKBREAKER(
     MachineSide::Rear,
     6);
 
-const static Machine ROLLERBACK(
+inline constexpr Machine ROLLERBACK(
     "Rollerback",
     MachineType::Melee,
     MachineSkill::Retaliate,
@@ -305,7 +306,7 @@ const static Machine ROLLERBACK(
     MachineSide::Rear,
     4);
 
-const static Machine SCORCHER(
+inline constexpr Machine SCORCHER(
     "Scorcher",
     MachineType::Dash,
     MachineSkill::Burn,
@@ -317,7 +318,7 @@ const static Machine SCORCHER(
     MachineSide::Rear,
     8);
 
-const static Machine SCRAPPER(
+inline constexpr Machine SCRAPPER(
     "Scrapper",
     MachineType::Gunner,
     MachineSkill::None,
@@ -329,7 +330,7 @@ const static Machine SCRAPPER(
     MachineSide::Rear,
     2);
 
-const static Machine SCROUNGER(
+inline constexpr Machine SCROUNGER(
     "Scrounger",
     MachineType::Melee,
     MachineSkill::None,
@@ -341,7 +342,7 @@ const static Machine SCROUNGER(
     MachineSide::Rear,
     1);
 
-const static Machine SHELLWALKER(
+inline constexpr Machine SHELLWALKER(
     "Shell-Walker",
     MachineType::Melee,
     MachineSkill::Shield,
@@ -353,7 +354,7 @@ const static Machine SHELLWALKER(
     MachineSide::Rear,
     3);
 
-const static Machine SHELLSNAPPER(
+inline constexpr Machine SHELLSNAPPER(
     "Shellsnapper",
     MachineType::Pull,
     MachineSkill::None,
@@ -365,7 +366,7 @@ const static Machine SHELLSNAPPER(
     MachineSide::Front,
     6);
 
-const static Machine SKYDRIFTER(
+inline constexpr Machine SKYDRIFTER(
     "Skydrifter",
     MachineType::Swoop,
     MachineSkill::None,
@@ -377,7 +378,7 @@ const static Machine SKYDRIFTER(
     MachineSide::Rear,
     2);
 
-const static Machine SLAUGHTERSPINE(
+inline constexpr Machine SLAUGHTERSPINE(
     "Slaughterspine",
     MachineType::Melee,
     MachineSkill::Spray,
@@ -389,7 +390,7 @@ const static Machine SLAUGHTERSPINE(
     MachineSide::Left | MachineSide::Right,
     10);
 
-const static Machine SLITHERFANG(
+inline constexpr Machine SLITHERFANG(
     "Slitherfang",
     MachineType::Dash,
     MachineSkill::AlterTerrain,
@@ -401,7 +402,7 @@ const static Machine SLITHERFANG(
     MachineSide::Rear,
     9);
 
-const static Machine SNAPMAW(
+inline constexpr Machine SNAPMAW(
     "Snapmaw",
     MachineType::Pull,
     MachineSkill::None,
@@ -413,7 +414,7 @@ const static Machine SNAPMAW(
     MachineSide::Rear,
     3);
 
-const static Machine SPIKESNOUT(
+inline constexpr Machine SPIKESNOUT(
     "Spikesnout",
     MachineType::Melee,
     MachineSkill::None,
@@ -425,7 +426,7 @@ const static Machine SPIKESNOUT(
     MachineSide::Rear,
     1);
 
-const static Machine STALKER(
+inline constexpr Machine STALKER(
     "Stalker",
     MachineType::Melee,
     MachineSkill::Stalk,
@@ -437,7 +438,7 @@ const static Machine STALKER(
     MachineSide::Rear,
     4);
 
-const static Machine STORMBIRD(
+inline constexpr Machine STORMBIRD(
     "Stormbird",
     MachineType::Swoop,
     MachineSkill::Sweep,
@@ -449,7 +450,7 @@ const static Machine STORMBIRD(
     MachineSide::Front,
     6);
 
-const static Machine SUNWING(
+inline constexpr Machine SUNWING(
     "Sunwing",
     MachineType::Swoop,
     MachineSkill::None,
@@ -461,7 +462,7 @@ const static Machine SUNWING(
     MachineSide::Front,
     3);
 
-const static Machine THUNDERJAW(
+inline constexpr Machine THUNDERJAW(
     "Thunderjaw",
     MachineType::Dash,
     MachineSkill::Sweep,
@@ -473,7 +474,7 @@ const static Machine THUNDERJAW(
     MachineSide::Left | MachineSide::Right,
     6);
 
-const static Machine TIDERIPPER(
+inline constexpr Machine TIDERIPPER(
     "Tideripper",
     MachineType::Pull,
     MachineSkill::None,
@@ -485,7 +486,7 @@ const static Machine TIDERIPPER(
     MachineSide::Rear,
     6);
 
-const static Machine TREMORTUSK(
+inline constexpr Machine TREMORTUSK(
     "Tremortusk",
     MachineType::Dash,
     MachineSkill::Sweep,
@@ -497,7 +498,7 @@ const static Machine TREMORTUSK(
     MachineSide::Rear,
     5);
 
-const static Machine WATERWING(
+inline constexpr Machine WATERWING(
     "Waterwing",
     MachineType::Pull,
     MachineSkill::Whiplash,
@@ -509,7 +510,7 @@ const static Machine WATERWING(
     MachineSide::Front,
     4);
 
-const static Machine WIDEMAW(
+inline constexpr Machine WIDEMAW(
     "Widemaw",
     MachineType::Pull,
     MachineSkill::None,
@@ -521,7 +522,7 @@ const static Machine WIDEMAW(
     MachineSide::Rear,
     3);
 
-const static std::vector<std::reference_wrapper<const Machine>> ALL_MACHINES = {
+inline constexpr std::array<std::reference_wrapper<const Machine>, 43> ALL_MACHINES = {
     std::ref(BEHEMOTH),
     std::ref(BELLOWBACK),
     std::ref(BILEGUT),
@@ -565,4 +566,28 @@ const static std::vector<std::reference_wrapper<const Machine>> ALL_MACHINES = {
     std::ref(TREMORTUSK),
     std::ref(WATERWING),
     std::ref(WIDEMAW),
-};
\ No newline at end of file
+};
+
+// Returns the definition id of a machine, which is its index in ALL_MACHINES, or -1 if it is not one of the definitions above.
+constexpr int32_t machine_id(const Machine &machine)
+{
+    for (size_t id = 0; id < ALL_MACHINES.size(); ++id)
+    {
+        if (&ALL_MACHINES[id].get() == &machine)
+            return static_cast<int32_t>(id);
+    }
+
+    return -1;
+}
+
+// Returns the definition id of the machine with the given name, or -1 if there is no such machine.
+constexpr int32_t find_machine_id(std::string_view name)
+{
+    for (size_t id = 0; id < ALL_MACHINES.size(); ++id)
+    {
+        if (name == ALL_MACHINES[id].get().name)
+            return static_cast<int32_t>(id);
+    }
+
+    return -1;
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "enums.h"
+#include "machine_definitions.h"
+#include "utils.h"
+
+constexpr size_t MACHINE_COUNT = ALL_MACHINES.size();
+
+// The squares from a square out to the edge of the board in one direction, nearest first, as row * 8 + column.
+class AttackRay
+{
+public:
+    uint8_t length = 0;
+    std::array<uint8_t, 7> squares{};
+};
+
+// Every machine definition laid out by field and indexed by definition id, so that the hot paths read a handful of
+// small contiguous arrays instead of chasing a reference to each definition. Built at compile time from ALL_MACHINES.
+class MachineTable
+{
+public:
+    std::array<MachineType, MACHINE_COUNT> machine_type{};
+    std::array<MachineSkill, MACHINE_COUNT> skill{};
+    std::array<int8_t, MACHINE_COUNT> health{};
+    std::array<int8_t, MACHINE_COUNT> attack{};
+    std::array<int8_t, MACHINE_COUNT> range{};
+    std::array<int8_t, MACHINE_COUNT> movement{};
+    std::array<int8_t, MACHINE_COUNT> points{};
+    std::array<bool, MACHINE_COUNT> flying{};
+    std::array<bool, MACHINE_COUNT> pull{};
+    std::array<bool, MACHINE_COUNT> mirror_symmetric{};
+    // Per facing, a bit for each attack direction (1 << direction) that lands on an armored or a weak side.
+    std::array<std::array<uint8_t, 4>, MACHINE_COUNT> armored_directions{};
+    std::array<std::array<uint8_t, 4>, MACHINE_COUNT> weak_directions{};
+    // Rays from every square in every direction; a machine reaches the first min(range, length) squares of one.
+    std::array<std::array<AttackRay, 4>, 64> rays{};
+    // Per square, a bit (1 << square) for every square on its row or column at most that many squares away.
+    std::array<std::array<uint64_t, 8>, 64> cross_masks{};
+
+    // The combat power a defender facing the given way gains or loses from the side an attack in the given direction hits.
+    constexpr int32_t side_modifier(int32_t id, MachineDirection facing, MachineDirection attack_direction) const
+    {
+        auto bit = 1 << static_cast<int32_t>(attack_direction);
+        if (armored_directions[id][static_cast<int32_t>(facing)] & bit)
+            return 1;
+        if (weak_directions[id][static_cast<int32_t>(facing)] & bit)
+            return -1;
+        return 0;
+    }
+
+    // How many squares of the ray from a square a machine can attack along.
+    constexpr int32_t reach(int32_t id, int32_t square, MachineDirection direction) const
+    {
+        auto length = rays[square][static_cast<int32_t>(direction)].length;
+        return range[id] < length ? range[id] : length;
+    }
+
+    // The squares a machine standing on a square has in attack range, matching Game::is_in_attack_range: the squares
+    // strictly closer than its range along its row and column.
+    constexpr uint64_t attack_range_mask(int32_t id, int32_t square) const
+    {
+        auto distance = range[id] - 1;
+        return cross_masks[square][distance < 0 ? 0 : distance > 7 ? 7 : distance];
+    }
+};
+
+constexpr MachineTable build_machine_table()
+{
+    constexpr std::array<MachineDirection, 4> directions = {MachineDirection::North, MachineDirection::East, MachineDirection::South, MachineDirection::West};
+
+    MachineTable table;
+    for (size_t id = 0; id < MACHINE_COUNT; ++id)
+    {
+        const auto &machine = ALL_MACHINES[id].get();
+        table.machine_type[id] = machine.machine_type;
+        table.skill[id] = machine.skill;
+        table.health[id] = static_cast<int8_t>(machine.health);
+        table.attack[id] = static_cast<int8_t>(machine.attack);
+        table.range[id] = static_cast<int8_t>(machine.range);
+        table.movement[id] = static_cast<int8_t>(machine.movement);
+        table.points[id] = static_cast<int8_t>(machine.points);
+        table.flying[id] = machine.is_flying();
+        table.pull[id] = machine.is_pull();
+        table.mirror_symmetric[id] = machine.is_mirror_symmetric();
+
+        for (auto facing : directions)
+        {
+            for (auto attack_direction : directions)
+            {
+                auto side = side_tangent_to_direction(attack_direction, facing);
+                auto bit = static_cast<uint8_t>(1 << static_cast<int32_t>(attack_direction));
+                if (static_cast<int32_t>(side & machine.armored_sides) != 0)
+                    table.armored_directions[id][static_cast<int32_t>(facing)] |= bit;
+                if (static_cast<int32_t>(side & machine.weak_sides) != 0)
+                    table.weak_directions[id][static_cast<int32_t>(facing)] |= bit;
+            }
+        }
+    }
+
+    constexpr std::array<int32_t, 4> row_steps = {-1, 0, 1, 0};
+    constexpr std::array<int32_t, 4> column_steps = {0, 1, 0, -1};
+    for (int32_t square = 0; square < 64; ++square)
+    {
+        for (int32_t direction = 0; direction < 4; ++direction)
+        {
+            auto &ray = table.rays[square][direction];
+            auto row = square / 8 + row_steps[direction];
+            auto column = square % 8 + column_steps[direction];
+            for (; row >= 0 && row < 8 && column >= 0 && column < 8; row += row_steps[direction], column += column_steps[direction])
+                ray.squares[ray.length++] = static_cast<uint8_t>(row * 8 + column);
+        }
+
+        for (int32_t distance = 1; distance < 8; ++distance)
+        {
+            auto &mask = table.cross_masks[square][distance];
+            mask = table.cross_masks[square][distance - 1];
+            for (const auto &ray : table.rays[square])
+            {
+                if (distance <= ray.length)
+                    mask |= uint64_t(1) << ray.squares[distance - 1];
+            }
+        }
+    }
+
+    return table;
+}
+
+inline constexpr MachineTable MACHINE_TABLE = build_machine_table();
+
+static_assert(MACHINE_TABLE.rays[0][static_cast<int32_t>(MachineDirection::South)].length == 7);
+static_assert(MACHINE_TABLE.rays[9][static_cast<int32_t>(MachineDirection::North)].squares[0] == 1);
+static_assert(MACHINE_TABLE.cross_masks[0][1] == ((uint64_t(1) << 1) | (uint64_t(1) << 8)));
@@ -6,6 +6,10 @@
 #include <algorithm>
 #include <vector>
 #include <string>
+#include <thread>
+#include <memory>
+#include <stdexcept>
+#include <set>
 #include "enums.h"
 #include "types.h"
 #include "coord.h"
@@ -13,318 +17,474 @@
 #include "game.h"
 #include "game_machine.h"
 #include "machine_definitions.h"
-
-BoardType<Terrain> parse_terrain(std::string &str)
-{
-    BoardType<Terrain> terrain;
-    for (int i = 0; i < 8; i++)
-    {
-        for (int j = 0; j < 8; j++)
-        {
-            switch (str[i * 8 + j])
-            {
-            case 'C':
-                terrain[{i, j}] = Terrain::Chasm;
-                break;
-            case 'M':
-                terrain[{i, j}] = Terrain::Marsh;
-                break;
-            case 'G':
-                terrain[{i, j}] = Terrain::Grassland;
-                break;
-            case 'F':
-                terrain[{i, j}] = Terrain::Forest;
-                break;
-            case 'H':
-                terrain[{i, j}] = Terrain::Hill;
-                break;
-            case 'm':
-                terrain[{i, j}] = Terrain::Mountain;
-                break;
-            default:
-                throw std::runtime_error("Invalid terrain character");
-            }
-        }
-    }
-
-    return terrain;
-}
-
-BoardType<std::optional<GameMachine>> parse_machines(std::string str)
-{
-    BoardType<std::optional<GameMachine>> machines;
-
-    auto machine_entries = split(str, ';');
-
-    if (machine_entries.size() != 64)
-    {
-        throw std::runtime_error("Invalid machine string");
-    }
-
-    for (int i = 0; i < 8; i++)
-    {
-        for (int j = 0; j < 8; j++)
-        {
-            auto machine_entry = machine_entries[i * 8 + j];
-
-            if (machine_entry.empty())
-                continue;
-
-            auto machine_data = split(machine_entry, ',');
-
-            if (machine_data.size() != 3)
-                throw std::runtime_error("Invalid machine data");
-
-            auto machine_name = machine_data[0];
-            auto machine = std::find_if(ALL_MACHINES.begin(), ALL_MACHINES.end(), [&machine_name](const std::reference_wrapper<const Machine> &m)
-                                        { return std::string(m.get().name) == machine_name; });
-
-            if (machine == ALL_MACHINES.end())
-                throw std::runtime_error("Invalid machine name" + machine_name);
-
-            auto machine_direction = machine_data[1];
-            MachineDirection direction;
-            if (machine_direction == "N")
-                direction = MachineDirection::North;
-            else if (machine_direction == "S")
-                direction = MachineDirection::South;
-            else if (machine_direction == "E")
-                direction = MachineDirection::East;
-            else if (machine_direction == "W")
-                direction = MachineDirection::West;
-            else
-                throw std::runtime_error("Invalid machine direction");
-
-            auto machine_side = machine_data[2];
-            Player side;
-            if (machine_side == "P")
-                side = Player::Player;
-            else if (machine_side == "O")
-                side = Player::Opponent;
-            else
-                throw std::runtime_error("Invalid machine side");
-
-            machines[{i, j}] = GameMachine(std::ref(*machine), direction, {i, j}, MachineState::Ready, side);
-        }
-    }
-
-    return machines;
-}
+#include "position.h"
+#include "game_record.h"
+#include "selfplay.h"
+#include "tablebase.h"
+#include "opening_book.h"
+#include "trace.h"
 
 int main()
 {
-    Game *game = nullptr;
+    // Null until newgame or replay, and again once the game is over.
+    std::unique_ptr<Game> game;
+    GameRecord record;
+    // Whether record holds a game, finished or not, since the last newgame or replay.
+    bool has_record = false;
+    std::shared_ptr<TranspositionTable> transposition_table;
+    SearchStats last_search_stats;
+    std::shared_ptr<const Tablebase> tablebase;
+    std::shared_ptr<const OpeningBook> opening_book;
 
     while (true)
     {
+        // The finished game's record keeps its result, so that it can still be saved before a new game starts.
         if (game != nullptr && game->check_winner() != Winner::None)
         {
             std::cout << "Game over" << std::endl;
             std::cout << "Winner: " << (game->check_winner() == Winner::Player ? "Player" : "Opponent") << std::endl;
-            delete game;
-            game = nullptr;
-            break;
+            record.result = game->check_winner();
+            game.reset();
         }
 
         std::string input;
-        std::getline(std::cin, input);
+        if (!std::getline(std::cin, input))
+            break;
 
         auto tokens = split(input, ' ');
 
-        if (tokens[0] == "newgame")
+        // Commands that act on the game in progress.
+        static const std::set<std::string> game_commands = {"rotate", "endturn", "moves", "print", "position", "attacks", "attack", "move", "search"};
+        if (game == nullptr && (game_commands.contains(tokens[0]) || (tokens[0] == "tablebase" && tokens.size() > 1 && tokens[1] == "build")))
         {
-            if (tokens.size() != 4)
-            {
-                std::cout << "Invalid newgame command" << std::endl;
-                continue;
-            }
-
-            auto terrain_str = tokens[1];
-            auto machines_str = tokens[2];
-            auto first = tokens[3];
-
-            auto terrain = parse_terrain(terrain_str);
-            auto machines = parse_machines(machines_str);
-
-            Player first_player;
-            if (first == "player")
-                first_player = Player::Player;
-            else if (first == "opponent")
-                first_player = Player::Opponent;
-            else
-                throw std::runtime_error("Invalid first player");
-
-            game = new Game(machines, terrain, first_player);
+            std::cout << "No game in progress" << std::endl;
+            continue;
         }
-        else if (tokens[0] == "rotate")
-        {
-            int row = std::stoi(tokens[1]);
-            int column = std::stoi(tokens[2]);
-            std::string rotation = tokens[3];
 
-            auto machine = game->board->machine_at({row, column});
-            if (machine == nullptr)
+        // A bad argument or an unreadable or unwritable file throws; report it and keep the REPL going.
+        try
+        {
+            if (tokens[0] == "newgame")
             {
-                std::cout << "No machine at that location" << std::endl;
-                continue;
+                if (tokens.size() != 4)
+                {
+                    std::cout << "Invalid newgame command" << std::endl;
+                    continue;
+                }
+
+                game = std::make_unique<Game>(parse_position(tokens[1], tokens[2], tokens[3]));
+                record = GameRecord(*game);
+                has_record = true;
             }
-
-            MachineDirection direction;
-            if (rotation == "N")
-                direction = MachineDirection::North;
-            else if (rotation == "S")
-                direction = MachineDirection::South;
-            else if (rotation == "E")
-                direction = MachineDirection::East;
-            else if (rotation == "W")
-                direction = MachineDirection::West;
-            else
+            else if (tokens[0] == "rotate")
             {
-                std::cout << "Invalid rotation" << std::endl;
-                continue;
+                if (tokens.size() != 4)
+                {
+                    std::cout << "Invalid rotate command" << std::endl;
+                    continue;
+                }
+
+                int row = std::stoi(tokens[1]);
+                int column = std::stoi(tokens[2]);
+                std::string rotation = tokens[3];
+
+                auto machine = game->board->machine_at({row, column});
+                if (machine == nullptr)
+                {
+                    std::cout << "No machine at that location" << std::endl;
+                    continue;
+                }
+
+                MachineDirection direction;
+                if (rotation == "N")
+                    direction = MachineDirection::North;
+                else if (rotation == "S")
+                    direction = MachineDirection::South;
+                else if (rotation == "E")
+                    direction = MachineDirection::East;
+                else if (rotation == "W")
+                    direction = MachineDirection::West;
+                else
+                {
+                    std::cout << "Invalid rotation" << std::endl;
+                    continue;
+                }
+
+                // Checked the same way a replay checks it, so that every recorded rotate can be replayed.
+                auto action = Action::rotate(machine->coordinates, direction);
+                if (!game->is_legal_action(action))
+                {
+                    std::cout << "Cannot rotate that machine" << std::endl;
+                    continue;
+                }
+
+                machine->direction = direction;
+                record.add_action(action);
             }
-
-            machine->direction = direction;
-        }
-        else if (tokens[0] == "endturn")
-        {
-            if (!game->can_end_turn())
+            else if (tokens[0] == "endturn")
             {
-                std::cout << "Cannot end turn" << std::endl;
-                continue;
+                if (!game->can_end_turn())
+                {
+                    std::cout << "Cannot end turn" << std::endl;
+                    continue;
+                }
+
+                game->end_turn();
+                record.add_action(Action::end_turn());
             }
-
-            game->end_turn();
-        }
-        else if (tokens[0] == "moves")
-        {
-            if (tokens.size() != 3)
+            else if (tokens[0] == "moves")
             {
-                std::cout << "Invalid moves command" << std::endl;
-                continue;
+                if (tokens.size() != 3)
+                {
+                    std::cout << "Invalid moves command" << std::endl;
+                    continue;
+                }
+
+                int row = std::stoi(tokens[1]);
+                int column = std::stoi(tokens[2]);
+
+                auto machine = game->board->machine_at({row, column});
+                if (machine == nullptr)
+                {
+                    std::cout << "No machine at that location" << std::endl;
+                    continue;
+                }
+                auto moves = game->calculate_moves(machine);
+                game->print_board(machine, moves);
             }
-
-            int row = std::stoi(tokens[1]);
-            int column = std::stoi(tokens[2]);
-
-            auto machine = game->board->machine_at({row, column});
-            if (machine == nullptr)
+            else if (tokens[0] == "print")
             {
-                std::cout << "No machine at that location" << std::endl;
-                continue;
+                game->print_board();
             }
-            auto moves = game->calculate_moves(machine);
-            game->print_board(machine, moves);
-        }
-        else if (tokens[0] == "print")
-        {
-            game->print_board();
-        }
-        else if (tokens[0] == "attacks")
-        {
-            if (tokens.size() != 3)
+            else if (tokens[0] == "position")
             {
-                std::cout << "Invalid attacks command" << std::endl;
-                continue;
+                std::cout << position_to_string(*game) << std::endl;
             }
-
-            int row = std::stoi(tokens[1]);
-            int column = std::stoi(tokens[2]);
-
-            auto machine = game->board->machine_at({row, column});
-            if (machine == nullptr)
+            else if (tokens[0] == "attacks")
             {
-                std::cout << "No machine at that location" << std::endl;
-                continue;
+                if (tokens.size() != 3)
+                {
+                    std::cout << "Invalid attacks command" << std::endl;
+                    continue;
+                }
+
+                int row = std::stoi(tokens[1]);
+                int column = std::stoi(tokens[2]);
+
+                auto machine = game->board->machine_at({row, column});
+                if (machine == nullptr)
+                {
+                    std::cout << "No machine at that location" << std::endl;
+                    continue;
+                }
+
+                auto attacks = game->calculate_attacks(machine);
+                game->print_board(machine, std::nullopt, attacks);
             }
-
-            auto attacks = game->calculate_attacks(machine);
-            game->print_board(machine, std::nullopt, attacks);
-        }
-        else if (tokens[0] == "attack")
-        {
-            if (tokens.size() != 5)
+            else if (tokens[0] == "attack")
             {
-                std::cout << "Invalid move command" << std::endl;
-                continue;
+                if (tokens.size() != 5)
+                {
+                    std::cout << "Invalid move command" << std::endl;
+                    continue;
+                }
+
+                int machine_row = std::stoi(tokens[1]);
+                int machine_column = std::stoi(tokens[2]);
+                std::string attack_direction = tokens[3];
+                bool overcharge = tokens[4] == "true";
+
+                auto machine = game->board->machine_at({machine_row, machine_column});
+                if (machine == nullptr)
+                {
+                    std::cout << "No machine at that location" << std::endl;
+                    continue;
+                }
+
+                MachineDirection direction;
+                if (attack_direction == "north")
+                    direction = MachineDirection::North;
+                else if (attack_direction == "south")
+                    direction = MachineDirection::South;
+                else if (attack_direction == "east")
+                    direction = MachineDirection::East;
+                else if (attack_direction == "west")
+                    direction = MachineDirection::West;
+                else
+                {
+                    std::cout << "Invalid direction" << std::endl;
+                    continue;
+                }
+
+                auto attacks = game->calculate_attacks(machine);
+
+                auto attack = std::find_if(attacks.begin(), attacks.end(), [&attack_direction, &direction, &overcharge](const Attack &a)
+                                           { return a.attack_direction_from_source == direction && ((overcharge && a.causes_state == MachineState::Overcharged) || (!overcharge && a.causes_state != MachineState::Overcharged)); });
+
+                if (attack == attacks.end())
+                {
+                    std::cout << "No attack in that direction" << std::endl;
+                    continue;
+                }
+
+                record.add_action(Action::from_attack(*attack));
+                game->make_attack(*attack);
             }
-
-            int machine_row = std::stoi(tokens[1]);
-            int machine_column = std::stoi(tokens[2]);
-            std::string attack_direction = tokens[3];
-            bool overcharge = tokens[4] == "true";
-
-            auto machine = game->board->machine_at({machine_row, machine_column});
-            if (machine == nullptr)
+            else if (tokens[0] == "move")
             {
-                std::cout << "No machine at that location" << std::endl;
-                continue;
+                if (tokens.size() != 6)
+                {
+                    std::cout << "Invalid move command" << std::endl;
+                    continue;
+                }
+
+                int machine_row = std::stoi(tokens[1]);
+                int machine_column = std::stoi(tokens[2]);
+                int destination_row = std::stoi(tokens[3]);
+                int destination_column = std::stoi(tokens[4]);
+                bool overcharge = tokens[5] == "true";
+
+                auto machine = game->board->machine_at({machine_row, machine_column});
+                if (machine == nullptr)
+                {
+                    std::cout << "No machine at that location" << std::endl;
+                    continue;
+                }
+
+                auto moves = game->calculate_moves(machine);
+                auto move = std::find_if(moves.begin(), moves.end(), [&destination_row, &destination_column, &overcharge](const Move &m)
+                                         { return m.destination == Coord{destination_row, destination_column} && ((overcharge && m.causes_state == MachineState::Overcharged) || (!overcharge && m.causes_state != MachineState::Overcharged)); });
+
+                if (move == moves.end())
+                {
+                    std::cout << "Invalid move" << std::endl;
+                    continue;
+                }
+
+                record.add_action(Action::from_move(*move));
+                game->make_move(*move);
             }
-
-            MachineDirection direction;
-            if (attack_direction == "north")
-                direction = MachineDirection::North;
-            else if (attack_direction == "south")
-                direction = MachineDirection::South;
-            else if (attack_direction == "east")
-                direction = MachineDirection::East;
-            else if (attack_direction == "west")
-                direction = MachineDirection::West;
-            else
+            else if (tokens[0] == "save")
             {
-                std::cout << "Invalid direction" << std::endl;
-                continue;
+                if (tokens.size() != 2)
+                {
+                    std::cout << "Invalid save command" << std::endl;
+                    continue;
+                }
+
+                if (!has_record)
+                {
+                    std::cout << "No game to save" << std::endl;
+                    continue;
+                }
+
+                if (game != nullptr)
+                    record.result = game->check_winner();
+
+                try
+                {
+                    record.save(tokens[1]);
+                }
+                catch (const std::exception &error)
+                {
+                    std::cout << "Save failed: " << error.what() << std::endl;
+                }
             }
-
-            auto attacks = game->calculate_attacks(machine);
-
-            auto attack = std::find_if(attacks.begin(), attacks.end(), [&attack_direction, &direction, &overcharge](const Attack &a)
-                                       { return a.attack_direction_from_source == direction && ((overcharge && a.causes_state == MachineState::Overcharged) || (!overcharge && a.causes_state != MachineState::Overcharged)); });
-
-            if (attack == attacks.end())
+            else if (tokens[0] == "replay")
             {
-                std::cout << "No attack in that direction" << std::endl;
-                continue;
+                if (tokens.size() != 2)
+                {
+                    std::cout << "Invalid replay command" << std::endl;
+                    continue;
+                }
+
+                // A missing, truncated or invalid file throws.
+                GameRecord loaded;
+                std::unique_ptr<Game> replayed;
+                try
+                {
+                    loaded = GameRecord::load(tokens[1]);
+                    replayed = std::make_unique<Game>(unpack_position(loaded.initial_position));
+                }
+                catch (const std::exception &error)
+                {
+                    std::cout << "Replay failed: " << error.what() << std::endl;
+                    continue;
+                }
+
+                auto result = replay_actions(*replayed, loaded, true);
+                if (!result.ok)
+                {
+                    std::cout << "Replay failed: " << result.error << std::endl;
+                    continue;
+                }
+
+                // Continue play from where the record left off.
+                game = std::move(replayed);
+                record = loaded;
+                has_record = true;
+
+                std::cout << "Replayed " << result.actions_applied << " actions" << std::endl;
             }
-
-            game->make_attack(*attack);
-        }
-        else if (tokens[0] == "move")
-        {
-            if (tokens.size() != 6)
+            else if (tokens[0] == "replaydir")
             {
-                std::cout << "Invalid move command" << std::endl;
-                continue;
+                if (tokens.size() != 2 && tokens.size() != 3)
+                {
+                    std::cout << "Invalid replaydir command" << std::endl;
+                    continue;
+                }
+
+                auto threads = tokens.size() == 3 ? std::stoi(tokens[2]) : std::thread::hardware_concurrency();
+                auto summary = replay_directory(tokens[1], threads, true);
+                for (const auto &failure : summary.failures)
+                    std::cout << failure << std::endl;
+
+                std::cout << "Records: " << summary.records << "\tFailed: " << summary.failed << "\tActions: " << summary.actions << "\tSeconds: " << summary.seconds << std::endl;
             }
-
-            int machine_row = std::stoi(tokens[1]);
-            int machine_column = std::stoi(tokens[2]);
-            int destination_row = std::stoi(tokens[3]);
-            int destination_column = std::stoi(tokens[4]);
-            bool overcharge = tokens[5] == "true";
-
-            auto machine = game->board->machine_at({machine_row, machine_column});
-            if (machine == nullptr)
+            else if (tokens[0] == "selfplay")
             {
-                std::cout << "No machine at that location" << std::endl;
-                continue;
+                if (tokens.size() < 3 || tokens.size() > 6)
+                {
+                    std::cout << "Invalid selfplay command" << std::endl;
+                    continue;
+                }
+
+                // A search config of "-" uses the defaults.
+                TournamentConfig config;
+                config.candidate = tokens[1] == "-" ? SearchConfig() : parse_search_config(tokens[1]);
+                config.baseline = tokens[2] == "-" ? SearchConfig() : parse_search_config(tokens[2]);
+                if (tokens.size() > 3)
+                    config.max_games = std::stoi(tokens[3]);
+                config.threads = tokens.size() > 4 ? std::stoi(tokens[4]) : std::thread::hardware_concurrency();
+                if (tokens.size() > 5)
+                    config.record_directory = tokens[5];
+
+                auto result = run_tournament(config);
+                std::cout << tournament_summary(config, result);
             }
-
-            auto moves = game->calculate_moves(machine);
-            auto move = std::find_if(moves.begin(), moves.end(), [&destination_row, &destination_column, &overcharge](const Move &m)
-                                     { return m.destination == Coord{destination_row, destination_column} && ((overcharge && m.causes_state == MachineState::Overcharged) || (!overcharge && m.causes_state != MachineState::Overcharged)); });
-
-            if (move == moves.end())
+            else if (tokens[0] == "book")
             {
-                std::cout << "Invalid move" << std::endl;
-                continue;
+                if (tokens.size() >= 4 && tokens.size() <= 7 && tokens[1] == "build")
+                {
+                    // book build <record_dir> <path> [max_actions] [search_config|-] [threads]
+                    BookBuildConfig config;
+                    config.record_directory = tokens[2];
+                    if (tokens.size() > 4)
+                        config.max_actions = std::stoi(tokens[4]);
+                    if (tokens.size() > 5)
+                    {
+                        config.search_positions = tokens[5] != "-";
+                        if (config.search_positions)
+                            config.search_config = parse_search_config(tokens[5]);
+                    }
+                    config.threads = tokens.size() > 6 ? std::stoi(tokens[6]) : std::thread::hardware_concurrency();
+
+                    auto summary = build_opening_book(config, tokens[3]);
+                    std::cout << "Records: " << summary.records << "\tFailed: " << summary.failed_records << "\tPositions: " << summary.positions << "\tSeconds: " << summary.seconds << std::endl;
+                    opening_book = std::make_shared<OpeningBook>(tokens[3]);
+                }
+                else if (tokens.size() == 3 && tokens[1] == "load")
+                {
+                    opening_book = std::make_shared<OpeningBook>(tokens[2]);
+                    std::cout << "Loaded " << opening_book->size() << " positions" << std::endl;
+                }
+                else if (tokens.size() == 2 && tokens[1] == "off")
+                {
+                    opening_book = nullptr;
+                }
+                else
+                {
+                    std::cout << "Invalid book command" << std::endl;
+                }
+            }
+            else if (tokens[0] == "tablebase")
+            {
+                if (tokens.size() >= 3 && tokens.size() <= 4 && tokens[1] == "build")
+                {
+                    auto threads = tokens.size() == 4 ? std::stoi(tokens[3]) : std::thread::hardware_concurrency();
+                    auto summary = build_tablebase(*game, tokens[2], threads);
+                    std::cout << "Positions: " << summary.positions << "\tWins: " << summary.wins << "\tLosses: " << summary.losses << "\tDraws: " << summary.draws << "\tPasses: " << summary.passes << "\tSeconds: " << summary.seconds << std::endl;
+                    tablebase = std::make_shared<Tablebase>(tokens[2]);
+                }
+                else if (tokens.size() == 3 && tokens[1] == "load")
+                {
+                    tablebase = std::make_shared<Tablebase>(tokens[2]);
+                    std::cout << "Loaded " << tablebase->description() << std::endl;
+                }
+                else if (tokens.size() == 2 && tokens[1] == "off")
+                {
+                    tablebase = nullptr;
+                }
+                else
+                {
+                    std::cout << "Invalid tablebase command" << std::endl;
+                }
+            }
+            else if (tokens[0] == "trace")
+            {
+                if (tokens.size() == 2 && tokens[1] == "start")
+                {
+                    if (!start_trace())
+                        std::cout << "Tracing is not compiled in. Configure with -DMACHINE_STRIKE_TRACING=ON" << std::endl;
+                }
+                else if (tokens.size() == 3 && tokens[1] == "stop")
+                {
+                    stop_trace(tokens[2]);
+                }
+                else
+                {
+                    std::cout << "Invalid trace command" << std::endl;
+                }
+            }
+            else if (tokens[0] == "stats")
+            {
+                std::cout << last_search_stats.to_string();
+            }
+            else if (tokens[0] == "search")
+            {
+                SearchConfig config;
+                if (tokens.size() > 1)
+                    config = parse_search_config(tokens[1]);
+
+                // The table is kept between searches and only rebuilt when its size or file changes.
+                if (config.hash_megabytes == 0)
+                    transposition_table = nullptr;
+                else if (transposition_table == nullptr || transposition_table->megabytes() != config.hash_megabytes || transposition_table->path() != config.hash_file)
+                    transposition_table = std::make_shared<TranspositionTable>(config.hash_megabytes, config.hash_file);
+                config.transposition_table = transposition_table;
+                config.tablebase = tablebase;
+                config.opening_book = opening_book;
+
+                auto result = game->search(config);
+                last_search_stats = result.stats;
+                if (!result.best_action.has_value())
+                {
+                    std::cout << "No legal action" << std::endl;
+                    continue;
+                }
+
+                std::cout << "Best: " << result.best_action->to_string() << "\tScore: " << result.score << "\tDepth: " << result.depth << "\tNodes: " << result.nodes << "\tSeconds: " << result.seconds << (result.from_book ? "\t(book)" : "") << std::endl;
+                std::cout << "PV:";
+                for (const auto &action : result.principal_variation)
+                    std::cout << " [" << action.to_string() << "]";
+                std::cout << std::endl;
+
+                // Multi-PV lines after the first, which is the PV above.
+                for (size_t i = 1; i < result.lines.size(); ++i)
+                {
+                    std::cout << "Line " << i + 1 << ":\tScore: " << result.lines[i].score << "\tPV:";
+                    for (const auto &action : result.lines[i].principal_variation)
+                        std::cout << " [" << action.to_string() << "]";
+                    std::cout << std::endl;
+                }
+
+                auto totals = result.stats.total();
+                std::cout << "Leaves: " << totals.leaf_evaluations << "\tCutoffs: " << totals.beta_cutoffs << "\tTT hits: " << totals.tt_hits << "/" << totals.tt_probes << "\tEval hits: " << totals.eval_cache_hits << "/" << totals.eval_cache_probes << "\tTB hits: " << totals.tablebase_hits << std::endl;
             }
-
-            game->make_move(*move);
         }
-        else if (tokens[0] == "search")
+        catch (const std::exception &error)
         {
-            game->search(5);
+            std::cout << "Error: " << error.what() << std::endl;
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include <stdexcept>
+#include <utility>
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string &path, MappedFileMode mode, size_t size) : writable(mode != MappedFileMode::ReadOnly)
+{
+    auto access = writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+    auto disposition = mode == MappedFileMode::Create ? CREATE_ALWAYS : OPEN_EXISTING;
+    file_handle = CreateFileA(path.c_str(), access, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE)
+    {
+        file_handle = nullptr;
+        throw std::runtime_error("Could not open " + path);
+    }
+
+    if (mode == MappedFileMode::Create)
+    {
+        length = size;
+    }
+    else
+    {
+        LARGE_INTEGER file_size;
+        GetFileSizeEx(file_handle, &file_size);
+        length = static_cast<size_t>(file_size.QuadPart);
+    }
+
+    if (length == 0)
+        return;
+
+    auto maximum_size = static_cast<uint64_t>(length);
+    mapping_handle = CreateFileMappingA(file_handle, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                        static_cast<DWORD>(maximum_size >> 32), static_cast<DWORD>(maximum_size), nullptr);
+    if (mapping_handle == nullptr)
+    {
+        close();
+        throw std::runtime_error("Could not map " + path);
+    }
+
+    bytes = static_cast<uint8_t *>(MapViewOfFile(mapping_handle, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, length));
+    if (bytes == nullptr)
+    {
+        close();
+        throw std::runtime_error("Could not map " + path);
+    }
+}
+
+void MappedFile::close()
+{
+    if (bytes != nullptr)
+        UnmapViewOfFile(bytes);
+    if (mapping_handle != nullptr)
+        CloseHandle(mapping_handle);
+    if (file_handle != nullptr)
+        CloseHandle(file_handle);
+
+    bytes = nullptr;
+    mapping_handle = nullptr;
+    file_handle = nullptr;
+    length = 0;
+}
+
+void MappedFile::flush()
+{
+    if (bytes != nullptr && writable)
+        FlushViewOfFile(bytes, length);
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : bytes(std::exchange(other.bytes, nullptr)), length(std::exchange(other.length, 0)), writable(other.writable),
+      file_handle(std::exchange(other.file_handle, nullptr)), mapping_handle(std::exchange(other.mapping_handle, nullptr))
+{
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        bytes = std::exchange(other.bytes, nullptr);
+        length = std::exchange(other.length, 0);
+        writable = other.writable;
+        file_handle = std::exchange(other.file_handle, nullptr);
+        mapping_handle = std::exchange(other.mapping_handle, nullptr);
+    }
+
+    return *this;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &path, MappedFileMode mode, size_t size) : writable(mode != MappedFileMode::ReadOnly)
+{
+    auto flags = mode == MappedFileMode::Create ? O_RDWR | O_CREAT | O_TRUNC : writable ? O_RDWR
+                                                                                         : O_RDONLY;
+    descriptor = ::open(path.c_str(), flags, 0644);
+    if (descriptor < 0)
+        throw std::runtime_error("Could not open " + path);
+
+    if (mode == MappedFileMode::Create)
+    {
+        if (::ftruncate(descriptor, static_cast<off_t>(size)) != 0)
+        {
+            close();
+            throw std::runtime_error("Could not resize " + path);
+        }
+        length = size;
+    }
+    else
+    {
+        struct stat status;
+        if (::fstat(descriptor, &status) != 0)
+        {
+            close();
+            throw std::runtime_error("Could not read the size of " + path);
+        }
+        length = static_cast<size_t>(status.st_size);
+    }
+
+    if (length == 0)
+        return;
+
+    auto mapping = ::mmap(nullptr, length, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, descriptor, 0);
+    if (mapping == MAP_FAILED)
+    {
+        close();
+        throw std::runtime_error("Could not map " + path);
+    }
+
+    bytes = static_cast<uint8_t *>(mapping);
+}
+
+void MappedFile::close()
+{
+    if (bytes != nullptr)
+        ::munmap(bytes, length);
+    if (descriptor >= 0)
+        ::close(descriptor);
+
+    bytes = nullptr;
+    descriptor = -1;
+    length = 0;
+}
+
+void MappedFile::flush()
+{
+    if (bytes != nullptr && writable)
+        ::msync(bytes, length, MS_SYNC);
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : bytes(std::exchange(other.bytes, nullptr)), length(std::exchange(other.length, 0)), writable(other.writable),
+      descriptor(std::exchange(other.descriptor, -1))
+{
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        bytes = std::exchange(other.bytes, nullptr);
+        length = std::exchange(other.length, 0);
+        writable = other.writable;
+        descriptor = std::exchange(other.descriptor, -1);
+    }
+
+    return *this;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
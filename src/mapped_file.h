@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum class MappedFileMode
+{
+    ReadOnly,
+    ReadWrite,
+    // Creates the file, or truncates an existing one, at the requested size.
+    Create,
+};
+
+// A whole file mapped into memory. Throws std::runtime_error if the file cannot be opened or mapped.
+class MappedFile
+{
+    uint8_t *bytes = nullptr;
+    size_t length = 0;
+    bool writable = false;
+#ifdef _WIN32
+    void *file_handle = nullptr;
+    void *mapping_handle = nullptr;
+#else
+    int descriptor = -1;
+#endif
+
+    void close();
+
+public:
+    // size is only used with MappedFileMode::Create.
+    MappedFile(const std::string &path, MappedFileMode mode, size_t size = 0);
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    ~MappedFile();
+
+    uint8_t *data() { return bytes; }
+    const uint8_t *data() const { return bytes; }
+    size_t size() const { return length; }
+
+    // Writes dirty pages back to disk.
+    void flush();
+};
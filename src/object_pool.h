@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Fixed size slots for objects of type T, handed out from a free list kept per thread so that making and dropping
+// objects on the hot path never touches malloc or a lock. Threads refill their list in batches from a pool shared by
+// the whole process, and the slots are only ever recycled, never returned, so an object may be destroyed on a
+// different thread than the one that created it.
+template <typename T>
+class ObjectPool
+{
+    union Slot
+    {
+        Slot *next;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    static constexpr size_t BATCH_SIZE = 256;
+
+    class Shared
+    {
+    public:
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Slot[]>> chunks;
+        Slot *free = nullptr;
+    };
+
+    class ThreadCache
+    {
+    public:
+        Slot *free = nullptr;
+        size_t count = 0;
+
+        ~ThreadCache() { release(*this); }
+    };
+
+    static Shared &shared()
+    {
+        static Shared instance;
+        return instance;
+    }
+
+    static ThreadCache &cache()
+    {
+        thread_local ThreadCache instance;
+        return instance;
+    }
+
+    static void refill(ThreadCache &thread_cache)
+    {
+        auto &pool = shared();
+        std::lock_guard lock(pool.mutex);
+
+        if (pool.free == nullptr)
+        {
+            auto &chunk = pool.chunks.emplace_back(std::make_unique<Slot[]>(BATCH_SIZE));
+            for (size_t i = 0; i < BATCH_SIZE; ++i)
+            {
+                chunk[i].next = pool.free;
+                pool.free = &chunk[i];
+            }
+        }
+
+        for (size_t i = 0; i < BATCH_SIZE && pool.free != nullptr; ++i)
+        {
+            auto slot = pool.free;
+            pool.free = slot->next;
+            slot->next = thread_cache.free;
+            thread_cache.free = slot;
+            ++thread_cache.count;
+        }
+    }
+
+    static void release(ThreadCache &thread_cache)
+    {
+        if (thread_cache.free == nullptr)
+            return;
+
+        auto tail = thread_cache.free;
+        while (tail->next != nullptr)
+            tail = tail->next;
+
+        auto &pool = shared();
+        std::lock_guard lock(pool.mutex);
+        tail->next = pool.free;
+        pool.free = thread_cache.free;
+        thread_cache.free = nullptr;
+        thread_cache.count = 0;
+    }
+
+public:
+    template <typename... Args>
+    static T *create(Args &&...args)
+    {
+        auto &thread_cache = cache();
+        if (thread_cache.free == nullptr)
+            refill(thread_cache);
+
+        auto slot = thread_cache.free;
+        thread_cache.free = slot->next;
+        --thread_cache.count;
+        return new (slot->storage) T(std::forward<Args>(args)...);
+    }
+
+    static void destroy(T *object)
+    {
+        if (object == nullptr)
+            return;
+
+        object->~T();
+        auto slot = reinterpret_cast<Slot *>(object);
+        auto &thread_cache = cache();
+        slot->next = thread_cache.free;
+        thread_cache.free = slot;
+        ++thread_cache.count;
+    }
+
+    // Hands every free slot this thread holds back to the shared pool in one go, e.g. once a search that made and
+    // dropped many games is over, so that other threads can reuse them.
+    static void release_thread_cache()
+    {
+        release(cache());
+    }
+
+    // Free slots held by this thread.
+    static size_t thread_cache_size()
+    {
+        return cache().count;
+    }
+};
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "opening_book.h"
+#include "game_record.h"
+#include "position.h"
+
+constexpr uint8_t BOOK_VERSION = 1;
+constexpr size_t BOOK_HEADER_SIZE = 16;
+constexpr size_t BOOK_ENTRY_SIZE = 16;
+
+static uint64_t read_little_endian(const uint8_t *bytes, int32_t size)
+{
+    uint64_t value = 0;
+    for (int32_t i = size - 1; i >= 0; --i)
+        value = (value << 8) | bytes[i];
+    return value;
+}
+
+static void write_little_endian(std::vector<uint8_t> &bytes, uint64_t value, int32_t size)
+{
+    for (int32_t i = 0; i < size; ++i)
+        bytes.push_back(static_cast<uint8_t>(value >> (i * 8)));
+}
+
+OpeningBook::OpeningBook(const std::string &path) : file(path, MappedFileMode::ReadOnly)
+{
+    auto header = file.data();
+    if (file.size() < BOOK_HEADER_SIZE || std::memcmp(header, "MSOB", 4) != 0)
+        throw std::runtime_error(path + " is not an opening book");
+    if (header[4] != BOOK_VERSION)
+        throw std::runtime_error("Unsupported opening book version " + std::to_string(header[4]));
+
+    count = read_little_endian(header + 8, 8);
+    if (file.size() != BOOK_HEADER_SIZE + count * BOOK_ENTRY_SIZE)
+        throw std::runtime_error(path + " is truncated");
+}
+
+BookEntry OpeningBook::entry_at(uint64_t index) const
+{
+    auto bytes = file.data() + BOOK_HEADER_SIZE + index * BOOK_ENTRY_SIZE;
+
+    BookEntry entry;
+    entry.key = read_little_endian(bytes, 8);
+    entry.action = static_cast<uint16_t>(read_little_endian(bytes + 8, 2));
+    entry.score = static_cast<int16_t>(read_little_endian(bytes + 10, 2));
+    entry.depth = bytes[12];
+    entry.games = static_cast<uint16_t>(read_little_endian(bytes + 14, 2));
+    return entry;
+}
+
+std::optional<BookEntry> OpeningBook::probe(uint64_t key) const
+{
+    uint64_t low = 0;
+    uint64_t high = count;
+    while (low < high)
+    {
+        auto middle = low + (high - low) / 2;
+        if (read_little_endian(file.data() + BOOK_HEADER_SIZE + middle * BOOK_ENTRY_SIZE, 8) < key)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    if (low == count)
+        return std::nullopt;
+
+    auto entry = entry_at(low);
+    if (entry.key != key)
+        return std::nullopt;
+
+    return entry;
+}
+
+// A position seen in the records, with how often each action was played from it.
+class BookCandidate
+{
+public:
+    PackedPosition position;
+    uint32_t games = 0;
+    // Whether the packed position is the mirror of the canonical form.
+    bool mirrored = false;
+    std::map<uint16_t, uint32_t> played;
+};
+
+BookBuildSummary build_opening_book(const BookBuildConfig &config, const std::string &path)
+{
+    auto start = std::chrono::steady_clock::now();
+    BookBuildSummary summary;
+
+    std::vector<std::string> paths;
+    for (const auto &entry : std::filesystem::directory_iterator(config.record_directory))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".msr")
+            paths.push_back(entry.path().string());
+    }
+
+    std::sort(paths.begin(), paths.end());
+    summary.records = paths.size();
+
+    std::unordered_map<uint64_t, BookCandidate> candidates;
+    for (const auto &record_path : paths)
+    {
+        uint32_t actions = 0;
+        auto visitor = [&](Game &game, const Action &action)
+        {
+            // Rotations are left out since the search never plays them.
+            if (actions++ >= config.max_actions || action.type == ActionType::Rotate)
+                return;
+
+            // Positions are keyed by their canonical form, and actions are kept in that form's frame.
+            auto [key, mirrored] = game.canonical_hash();
+            auto &candidate = candidates[key];
+            if (candidate.games == 0)
+            {
+                candidate.position = pack_position(game);
+                candidate.mirrored = mirrored;
+            }
+            ++candidate.games;
+            ++candidate.played[(mirrored ? action.mirrored() : action).encode()];
+        };
+
+        // Positions from before an illegal action are still kept.
+        ReplayResult result;
+        try
+        {
+            result = replay_record(GameRecord::load(record_path), true, visitor);
+        }
+        catch (const std::exception &)
+        {
+            result.ok = false;
+        }
+
+        if (!result.ok)
+            ++summary.failed_records;
+    }
+
+    std::vector<BookEntry> entries;
+    std::vector<const BookCandidate *> to_search;
+    for (const auto &[key, candidate] : candidates)
+    {
+        if (candidate.games < config.min_games)
+            continue;
+
+        auto most_played = std::max_element(candidate.played.begin(), candidate.played.end(), [](const auto &a, const auto &b)
+                                            { return a.second < b.second; });
+
+        BookEntry entry;
+        entry.key = key;
+        entry.action = most_played->first;
+        entry.games = static_cast<uint16_t>(std::min<uint32_t>(candidate.games, UINT16_MAX));
+        entries.push_back(entry);
+        to_search.push_back(&candidate);
+    }
+
+    if (config.search_positions)
+    {
+        std::atomic<size_t> next_entry = 0;
+        auto worker = [&]()
+        {
+            auto search_config = config.search_config;
+            if (search_config.transposition_table == nullptr && search_config.hash_megabytes > 0)
+                search_config.transposition_table = std::make_shared<TranspositionTable>(search_config.hash_megabytes);
+
+            for (auto i = next_entry++; i < entries.size(); i = next_entry++)
+            {
+                auto game = unpack_position(to_search[i]->position);
+                auto result = game.search(search_config);
+                if (!result.best_action.has_value())
+                    continue;
+
+                entries[i].action = (to_search[i]->mirrored ? result.best_action->mirrored() : result.best_action.value()).encode();
+                entries[i].score = static_cast<int16_t>(result.score);
+                entries[i].depth = static_cast<uint8_t>(std::min(result.depth, 255));
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (uint32_t i = 0; i < std::max(config.threads, 1u); ++i)
+            workers.emplace_back(worker);
+        for (auto &thread : workers)
+            thread.join();
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const BookEntry &a, const BookEntry &b)
+              { return a.key < b.key; });
+
+    std::vector<uint8_t> bytes{'M', 'S', 'O', 'B', BOOK_VERSION, 0, 0, 0};
+    write_little_endian(bytes, entries.size(), 8);
+    for (const auto &entry : entries)
+    {
+        write_little_endian(bytes, entry.key, 8);
+        write_little_endian(bytes, entry.action, 2);
+        write_little_endian(bytes, static_cast<uint16_t>(entry.score), 2);
+        write_little_endian(bytes, entry.depth, 1);
+        write_little_endian(bytes, 0, 1);
+        write_little_endian(bytes, entry.games, 2);
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+    if (!file)
+        throw std::runtime_error("Could not write " + path);
+
+    summary.positions = entries.size();
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return summary;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include "action.h"
+#include "mapped_file.h"
+#include "search.h"
+
+class BookEntry
+{
+public:
+    uint64_t key = 0;
+    uint16_t action = 0;
+    // From the perspective of the side to move, as found by the offline search.
+    int16_t score = 0;
+    // Depth of the offline search, or 0 if the action was taken from the records alone.
+    uint8_t depth = 0;
+    // How many recorded games reached the position.
+    uint16_t games = 0;
+
+    Action best_action() const { return Action::decode(action); }
+};
+
+// A table of positions, keyed by Game::canonical_hash, and the action to play from each, memory-mapped from disk.
+// Actions are stored for the canonical form, so they are mirrored back when the probed position was the mirror.
+//
+// On disk a book is:
+//   4 bytes  "MSOB"
+//   1 byte   format version
+//   3 bytes  reserved
+//   8 bytes  entry count, little-endian
+//   16 bytes per entry, sorted by key, all little-endian:
+//            key (8), action (2), score (2), depth (1), reserved (1), games (2)
+class OpeningBook
+{
+    MappedFile file;
+    uint64_t count = 0;
+
+    BookEntry entry_at(uint64_t index) const;
+
+public:
+    explicit OpeningBook(const std::string &path);
+
+    std::optional<BookEntry> probe(uint64_t key) const;
+    uint64_t size() const { return count; }
+};
+
+class BookBuildConfig
+{
+public:
+    // Every .msr game record in this directory is replayed.
+    std::string record_directory;
+    // Positions more than this many actions into a game are left out.
+    uint32_t max_actions = 16;
+    // Positions reached by fewer games than this are left out.
+    uint32_t min_games = 2;
+    // If set, every position is searched with search_config and the book plays the searched action.
+    // Otherwise the book plays the action that was played most often from the position.
+    bool search_positions = true;
+    SearchConfig search_config;
+    uint32_t threads = 1;
+};
+
+class BookBuildSummary
+{
+public:
+    size_t records = 0;
+    size_t failed_records = 0;
+    size_t positions = 0;
+    double seconds = 0;
+};
+
+BookBuildSummary build_opening_book(const BookBuildConfig &config, const std::string &path);
@@ -0,0 +1,450 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include "position.h"
+#include "machine_definitions.h"
+
+// Layout of a packed position, as a little-endian bit stream:
+//   5 bits  machine count
+//   1 bit   turn
+//   2 bits  game state
+//   1 bit   must move last touched machine
+//   5 bits  index of the last touched machine (31 if none)
+//   6 bits  player victory points
+//   6 bits  opponent victory points
+//   3 bits  terrain, for each of the 64 spaces in row major order
+//   26 bits per machine, in row major order:
+//     6 bits  space
+//     6 bits  machine definition id
+//     2 bits  direction
+//     1 bit   side
+//     3 bits  machine state
+//     4 bits  health
+//     4 bits  attack power modifier, biased by 8
+
+constexpr uint32_t NO_LAST_TOUCHED_MACHINE = 31;
+constexpr int32_t ATTACK_POWER_MODIFIER_BIAS = 8;
+
+class BitWriter
+{
+    std::span<uint8_t> buffer;
+    size_t bit = 0;
+
+public:
+    BitWriter(std::span<uint8_t> buffer) : buffer(buffer) {}
+
+    void write(uint32_t value, int32_t bits)
+    {
+        for (int i = 0; i < bits; ++i, ++bit)
+        {
+            auto mask = static_cast<uint8_t>(1 << (bit % 8));
+            if ((value >> i) & 1)
+                buffer[bit / 8] |= mask;
+            else
+                buffer[bit / 8] &= ~mask;
+        }
+    }
+};
+
+class BitReader
+{
+    std::span<const uint8_t> buffer;
+    size_t bit = 0;
+
+public:
+    BitReader(std::span<const uint8_t> buffer) : buffer(buffer) {}
+
+    uint32_t read(int32_t bits)
+    {
+        if (bit + bits > buffer.size() * 8)
+            throw std::runtime_error("Truncated position");
+
+        uint32_t value = 0;
+        for (int i = 0; i < bits; ++i, ++bit)
+            value |= static_cast<uint32_t>((buffer[bit / 8] >> (bit % 8)) & 1) << i;
+
+        return value;
+    }
+};
+
+static int32_t count_machines(const Game &game)
+{
+    int32_t count = 0;
+    for (const auto &row : game.board->machines.data)
+    {
+        for (auto machine : row)
+        {
+            if (machine != nullptr)
+                ++count;
+        }
+    }
+
+    return count;
+}
+
+size_t encoded_position_size(const Game &game)
+{
+    return (26 + 64 * 3 + 26 * count_machines(game) + 7) / 8;
+}
+
+size_t encode_position(const Game &game, std::span<uint8_t> buffer)
+{
+    auto machine_count = count_machines(game);
+    if (machine_count > MAX_PACKED_MACHINES)
+        throw std::runtime_error("Too many machines to encode");
+
+    auto size = encoded_position_size(game);
+    if (buffer.size() < size)
+        throw std::runtime_error("Position buffer too small");
+
+    uint32_t last_touched = NO_LAST_TOUCHED_MACHINE;
+    int32_t index = 0;
+    for (int row = 0; row < 8; ++row)
+    {
+        for (int column = 0; column < 8; ++column)
+        {
+            auto machine = game.board->machines.data[row][column];
+            if (machine == nullptr)
+                continue;
+
+            if (machine == game.last_touched_machine)
+                last_touched = index;
+            ++index;
+        }
+    }
+
+    BitWriter writer(buffer);
+    writer.write(machine_count, 5);
+    writer.write(static_cast<uint32_t>(game.turn), 1);
+    writer.write(static_cast<uint32_t>(game.state), 2);
+    writer.write(game.must_move_last_touched_machine, 1);
+    writer.write(last_touched, 5);
+    writer.write(std::min(game.player_victory_points, 63), 6);
+    writer.write(std::min(game.opponent_victory_points, 63), 6);
+
+    for (const auto &row : game.board->terrain->spaces.data)
+    {
+        for (auto terrain : row)
+            writer.write(static_cast<int32_t>(terrain) - static_cast<int32_t>(Terrain::Chasm), 3);
+    }
+
+    for (int row = 0; row < 8; ++row)
+    {
+        for (int column = 0; column < 8; ++column)
+        {
+            auto machine = game.board->machines.data[row][column];
+            if (machine == nullptr)
+                continue;
+
+            auto id = machine_id(machine->machine.get());
+            if (id < 0)
+                throw std::runtime_error(std::string("Unknown machine definition ") + machine->machine.get().name);
+
+            writer.write(row * 8 + column, 6);
+            writer.write(id, 6);
+            writer.write(static_cast<uint32_t>(machine->direction), 2);
+            writer.write(static_cast<uint32_t>(machine->side), 1);
+            writer.write(static_cast<uint32_t>(machine->machine_state), 3);
+            writer.write(std::clamp(machine->health, 0, 15), 4);
+            writer.write(std::clamp(machine->attack_power_modifier + ATTACK_POWER_MODIFIER_BIAS, 0, 15), 4);
+        }
+    }
+
+    return size;
+}
+
+Game decode_position(std::span<const uint8_t> buffer)
+{
+    BitReader reader(buffer);
+    auto machine_count = reader.read(5);
+    auto turn = static_cast<Player>(reader.read(1));
+    auto state = reader.read(2);
+    bool must_move_last_touched_machine = reader.read(1);
+    auto last_touched = reader.read(5);
+    auto player_victory_points = static_cast<int32_t>(reader.read(6));
+    auto opponent_victory_points = static_cast<int32_t>(reader.read(6));
+
+    if (state > static_cast<uint32_t>(GameState::MustEndTurn))
+        throw std::runtime_error("Invalid game state");
+
+    BoardType<Terrain> terrain;
+    for (auto &row : terrain.data)
+    {
+        for (auto &space : row)
+        {
+            auto value = reader.read(3);
+            if (value > static_cast<uint32_t>(Terrain::Mountain) - static_cast<uint32_t>(Terrain::Chasm))
+                throw std::runtime_error("Invalid terrain");
+            space = static_cast<Terrain>(static_cast<int32_t>(value) + static_cast<int32_t>(Terrain::Chasm));
+        }
+    }
+
+    BoardType<std::optional<GameMachine>> machines{std::nullopt};
+    std::optional<Coord> last_touched_coordinates;
+    for (uint32_t i = 0; i < machine_count; ++i)
+    {
+        auto space = reader.read(6);
+        auto id = reader.read(6);
+        auto direction = static_cast<MachineDirection>(reader.read(2));
+        auto side = static_cast<Player>(reader.read(1));
+        auto machine_state = reader.read(3);
+        auto health = static_cast<int32_t>(reader.read(4));
+        auto attack_power_modifier = static_cast<int32_t>(reader.read(4)) - ATTACK_POWER_MODIFIER_BIAS;
+
+        if (id >= ALL_MACHINES.size())
+            throw std::runtime_error("Invalid machine definition id");
+        if (machine_state > static_cast<uint32_t>(MachineState::MustMove))
+            throw std::runtime_error("Invalid machine state");
+
+        Coord coordinates{static_cast<int32_t>(space / 8), static_cast<int32_t>(space % 8)};
+        auto &machine = machines[coordinates];
+        if (machine.has_value())
+            throw std::runtime_error("Two machines on one space");
+
+        machine = GameMachine(ALL_MACHINES[id], direction, coordinates, static_cast<MachineState>(machine_state), side);
+        machine->health = health;
+        machine->attack_power_modifier = attack_power_modifier;
+
+        if (i == last_touched)
+            last_touched_coordinates = coordinates;
+    }
+
+    Game game(machines, terrain, turn);
+    game.state = static_cast<GameState>(state);
+    game.must_move_last_touched_machine = must_move_last_touched_machine;
+    game.player_victory_points = player_victory_points;
+    game.opponent_victory_points = opponent_victory_points;
+    if (last_touched_coordinates.has_value())
+        game.last_touched_machine = game.board->machine_at(last_touched_coordinates.value());
+
+    return game;
+}
+
+PackedPosition pack_position(const Game &game)
+{
+    PackedPosition position;
+    position.size = static_cast<uint8_t>(encode_position(game, position.bytes));
+    return position;
+}
+
+Game unpack_position(const PackedPosition &position)
+{
+    return decode_position(position.data());
+}
+
+static Terrain parse_terrain_character(char c)
+{
+    switch (c)
+    {
+    case 'C':
+        return Terrain::Chasm;
+    case 'M':
+        return Terrain::Marsh;
+    case 'G':
+        return Terrain::Grassland;
+    case 'F':
+        return Terrain::Forest;
+    case 'H':
+        return Terrain::Hill;
+    case 'm':
+        return Terrain::Mountain;
+    default:
+        throw std::runtime_error("Invalid terrain character");
+    }
+}
+
+static char terrain_character(Terrain terrain)
+{
+    switch (terrain)
+    {
+    case Terrain::Chasm:
+        return 'C';
+    case Terrain::Marsh:
+        return 'M';
+    case Terrain::Grassland:
+        return 'G';
+    case Terrain::Forest:
+        return 'F';
+    case Terrain::Hill:
+        return 'H';
+    case Terrain::Mountain:
+        return 'm';
+    }
+
+    throw std::invalid_argument("Invalid terrain");
+}
+
+static char direction_character(MachineDirection direction)
+{
+    switch (direction)
+    {
+    case MachineDirection::North:
+        return 'N';
+    case MachineDirection::East:
+        return 'E';
+    case MachineDirection::South:
+        return 'S';
+    case MachineDirection::West:
+        return 'W';
+    }
+
+    throw std::invalid_argument("Invalid direction");
+}
+
+BoardType<Terrain> parse_terrain(std::string_view str)
+{
+    if (str.size() != 64)
+        throw std::runtime_error("Invalid terrain string");
+
+    BoardType<Terrain> terrain;
+    for (int i = 0; i < 8; i++)
+    {
+        for (int j = 0; j < 8; j++)
+            terrain[{i, j}] = parse_terrain_character(str[i * 8 + j]);
+    }
+
+    return terrain;
+}
+
+// Each of the 64 entries is either empty or <name>,<N|E|S|W>,<P|O>[,<health>]. The health is optional and defaults to the machine's full health.
+BoardType<std::optional<GameMachine>> parse_machines(std::string_view str)
+{
+    BoardType<std::optional<GameMachine>> machines{std::nullopt};
+
+    size_t start = 0;
+    for (int index = 0; index < 64; ++index)
+    {
+        auto end = str.find(';', start);
+        if ((index < 63) == (end == std::string_view::npos))
+            throw std::runtime_error("Invalid machine string");
+
+        auto machine_entry = str.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+        start = end + 1;
+
+        if (machine_entry.empty())
+            continue;
+
+        auto name_end = machine_entry.find(',');
+        if (name_end == std::string_view::npos || machine_entry.size() < name_end + 4 || machine_entry[name_end + 2] != ',')
+            throw std::runtime_error("Invalid machine data");
+
+        auto machine_name = machine_entry.substr(0, name_end);
+        auto id = find_machine_id(machine_name);
+        if (id < 0)
+            throw std::runtime_error("Invalid machine name" + std::string(machine_name));
+
+        MachineDirection direction;
+        switch (machine_entry[name_end + 1])
+        {
+        case 'N':
+            direction = MachineDirection::North;
+            break;
+        case 'S':
+            direction = MachineDirection::South;
+            break;
+        case 'E':
+            direction = MachineDirection::East;
+            break;
+        case 'W':
+            direction = MachineDirection::West;
+            break;
+        default:
+            throw std::runtime_error("Invalid machine direction");
+        }
+
+        Player side;
+        switch (machine_entry[name_end + 3])
+        {
+        case 'P':
+            side = Player::Player;
+            break;
+        case 'O':
+            side = Player::Opponent;
+            break;
+        default:
+            throw std::runtime_error("Invalid machine side");
+        }
+
+        Coord coordinates{index / 8, index % 8};
+        auto &machine = machines[coordinates];
+        machine = GameMachine(ALL_MACHINES[id], direction, coordinates, MachineState::Ready, side);
+
+        auto rest = machine_entry.substr(name_end + 4);
+        if (!rest.empty())
+        {
+            if (rest[0] != ',' || rest.size() < 2)
+                throw std::runtime_error("Invalid machine data");
+
+            int32_t health = 0;
+            for (auto c : rest.substr(1))
+            {
+                if (c < '0' || c > '9')
+                    throw std::runtime_error("Invalid machine health");
+                health = health * 10 + (c - '0');
+            }
+
+            machine->health = health;
+        }
+    }
+
+    return machines;
+}
+
+Game parse_position(std::string_view terrain, std::string_view machines, std::string_view first)
+{
+    Player first_player;
+    if (first == "player")
+        first_player = Player::Player;
+    else if (first == "opponent")
+        first_player = Player::Opponent;
+    else
+        throw std::runtime_error("Invalid first player");
+
+    return Game(parse_machines(machines), parse_terrain(terrain), first_player);
+}
+
+std::string terrain_to_string(const Game &game)
+{
+    std::string str;
+    str.reserve(64);
+    for (const auto &row : game.board->terrain->spaces.data)
+    {
+        for (auto terrain : row)
+            str.push_back(terrain_character(terrain));
+    }
+
+    return str;
+}
+
+std::string machines_to_string(const Game &game)
+{
+    std::string str;
+    for (int row = 0; row < 8; ++row)
+    {
+        for (int column = 0; column < 8; ++column)
+        {
+            if (row != 0 || column != 0)
+                str.push_back(';');
+
+            auto machine = game.board->machines.data[row][column];
+            if (machine == nullptr)
+                continue;
+
+            str += machine->machine.get().name;
+            str.push_back(',');
+            str.push_back(direction_character(machine->direction));
+            str.push_back(',');
+            str.push_back(machine->side == Player::Player ? 'P' : 'O');
+
+            if (machine->health != machine->machine.get().health)
+                str += "," + std::to_string(machine->health);
+        }
+    }
+
+    return str;
+}
+
+std::string position_to_string(const Game &game)
+{
+    return terrain_to_string(game) + " " + machines_to_string(game) + " " + (game.turn == Player::Player ? "player" : "opponent");
+}
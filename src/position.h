@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include "types.h"
+#include "enums.h"
+#include "game.h"
+
+// The most machines a packed position can hold. The machine count is stored in 5 bits.
+constexpr int32_t MAX_PACKED_MACHINES = 31;
+// Header bits + 64 terrain spaces * 3 bits + 26 bits per machine, rounded up to whole bytes.
+constexpr size_t MAX_PACKED_POSITION_SIZE = (26 + 64 * 3 + 26 * MAX_PACKED_MACHINES + 7) / 8;
+
+// A position packed into a fixed size buffer. Only the first `size` bytes are meaningful.
+// A typical board with eight machines packs into 54 bytes.
+class PackedPosition
+{
+public:
+    uint8_t size = 0;
+    std::array<uint8_t, MAX_PACKED_POSITION_SIZE> bytes{};
+
+    std::span<const uint8_t> data() const
+    {
+        return {bytes.data(), size};
+    }
+};
+
+// Returns the number of bytes encode_position will write for this game.
+size_t encoded_position_size(const Game &game);
+// Writes the game into the buffer and returns the number of bytes written. Throws if the buffer is too small.
+size_t encode_position(const Game &game, std::span<uint8_t> buffer);
+// Reads a game previously written by encode_position. Throws if the buffer is truncated or malformed.
+Game decode_position(std::span<const uint8_t> buffer);
+
+PackedPosition pack_position(const Game &game);
+Game unpack_position(const PackedPosition &position);
+
+// Text form. These use the same tokens as the newgame command: <terrain> <machines> <player|opponent>.
+BoardType<Terrain> parse_terrain(std::string_view str);
+BoardType<std::optional<GameMachine>> parse_machines(std::string_view str);
+Game parse_position(std::string_view terrain, std::string_view machines, std::string_view first);
+std::string terrain_to_string(const Game &game);
+std::string machines_to_string(const Game &game);
+std::string position_to_string(const Game &game);
@@ -0,0 +1,84 @@
+#include <unordered_map>
+#include "reachability.h"
+
+// Beyond this many entries a thread's cache starts over, which only happens when many different terrains are searched.
+constexpr size_t MAX_CACHED_REACHABILITY = 1 << 16;
+
+class ReachabilityKey
+{
+public:
+    uint64_t terrain_hash;
+    int32_t source;
+    int32_t max_distance;
+    MovementClass movement_class;
+
+    bool operator==(const ReachabilityKey &other) const = default;
+};
+
+class ReachabilityKeyHash
+{
+public:
+    size_t operator()(const ReachabilityKey &key) const
+    {
+        auto mixed = key.terrain_hash ^ (static_cast<uint64_t>(key.source) << 8) ^ (static_cast<uint64_t>(key.max_distance) << 16) ^
+                     (static_cast<uint64_t>(key.movement_class) << 24);
+        return static_cast<size_t>(mixed ^ (mixed >> 32));
+    }
+};
+
+// The same breadth first walk as Game::expand_moves, minus the occupancy checks.
+static Reachability find_reachable_spaces(const Board &board, Coord source, int32_t max_distance, MovementClass movement_class)
+{
+    Reachability reachability;
+    uint64_t visited = 0;
+
+    auto expand = [&](int32_t distance, Coord coord)
+    {
+        if (distance > max_distance)
+            return;
+        if (distance > 1 && movement_class == MovementClass::Walker && board.terrain_at(coord) == Terrain::Marsh)
+            return;
+
+        for (const auto &pair : {std::make_pair(-1, 0), std::make_pair(1, 0), std::make_pair(0, -1), std::make_pair(0, 1)})
+        {
+            Coord next{coord.row + pair.first, coord.column + pair.second};
+            if (next.out_of_bounds())
+                continue;
+
+            auto space = next.row * 8 + next.column;
+            auto bit = uint64_t(1) << space;
+            if ((visited & bit) != 0)
+                continue;
+            if (movement_class != MovementClass::Flying && board.terrain_at(next) == Terrain::Chasm)
+                continue;
+
+            reachability.spaces.push_back({static_cast<uint8_t>(space), static_cast<uint8_t>(distance)});
+            visited |= bit;
+        }
+    };
+
+    expand(1, source);
+    for (size_t i = 0; i < reachability.spaces.size(); ++i)
+    {
+        auto [space, distance] = reachability.spaces[i];
+        expand(distance + 1, Coord(space / 8, space % 8));
+    }
+
+    reachability.mask = visited;
+    return reachability;
+}
+
+const Reachability &reachable_spaces(const Board &board, Coord source, int32_t max_distance, MovementClass movement_class)
+{
+    thread_local std::unordered_map<ReachabilityKey, Reachability, ReachabilityKeyHash> cache;
+
+    ReachabilityKey key{board.terrain->hash, source.row * 8 + source.column, max_distance, movement_class};
+    auto found = cache.find(key);
+    if (found != cache.end())
+        return found->second;
+
+    if (cache.size() >= MAX_CACHED_REACHABILITY)
+        cache.clear();
+
+    return cache.emplace(key, find_reachable_spaces(board, source, max_distance, movement_class)).first->second;
+}
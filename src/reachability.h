@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "board.h"
+#include "coord.h"
+
+// How terrain limits a machine's movement: walkers cannot enter chasms or keep moving once in a marsh, pull machines
+// move through marshes freely, and flying machines ignore terrain altogether.
+enum class MovementClass
+{
+    Walker,
+    Pull,
+    Flying,
+};
+
+class ReachableSpace
+{
+public:
+    uint8_t space;
+    uint8_t distance;
+};
+
+class Reachability
+{
+public:
+    // Every space a machine could pass through, in the order expand_moves finds them, with the fewest steps to get there.
+    std::vector<ReachableSpace> spaces;
+    // A bit (1 << space) for each of them.
+    uint64_t mask = 0;
+};
+
+// The spaces reachable from source in at most max_distance steps on the board's terrain, treating every machine as
+// something to pass over. Results are cached per thread by terrain hash, so set_terrain invalidates them.
+// Only valid while no machine stands on a chasm a walker could then cross by passing over it; see calculate_moves.
+const Reachability &reachable_spaces(const Board &board, Coord source, int32_t max_distance, MovementClass movement_class);
@@ -1,106 +1,830 @@
 #include "game.h"
+#include "search.h"
+#include "machine_table.h"
+#include "evaluation_cache.h"
+#include "object_pool.h"
+#include "opening_book.h"
+#include "tablebase.h"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include "trace.h"
 
-inline int32_t get_score(Game &game, Player playing_as)
+constexpr int32_t INFINITE_SCORE = 1000000;
+constexpr int32_t MAX_PLY = 128;
+
+// A candidate action along with the generated move or attack it came from, so children can be made without regenerating.
+class SearchMove
+{
+public:
+    Action action;
+    std::optional<Move> move;
+    std::optional<Attack> attack;
+
+    SearchMove(const Move &move) : action(Action::from_move(move)), move(move) {}
+    SearchMove(const Attack &attack) : action(Action::from_attack(attack)), attack(attack) {}
+    SearchMove(const Action &action) : action(action) {}
+
+    // Higher goes first. Only set for attacks.
+    int32_t order = 0;
+    // Whether the attack is predicted to gain victory points. Only set for attacks.
+    bool winning = false;
+};
+
+class SearchContext
+{
+public:
+    const SearchConfig &config;
+    TranspositionTable *transposition_table;
+    SearchStats stats;
+    EvaluationCache evaluation_cache;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint64_t nodes = 0;
+    // Seconds after which the search stops. Zero means no time limit.
+    double time_limit = 0;
+    int32_t completed_depth = 0;
+    // Actions searched at the root in the last root search.
+    size_t root_actions = 0;
+    bool stopped = false;
+    // Root actions left out of the current search, because earlier lines of a multi-PV iteration already took them.
+    std::vector<Action> excluded_root_actions;
+    // Set by the main thread to stop helper threads.
+    const std::atomic<bool> *stop_helpers = nullptr;
+    std::vector<std::vector<Action>> principal_variation = std::vector<std::vector<Action>>(MAX_PLY + 1);
+    // Whether the node at each ply was reached by skipping a turn, so that two skips never follow one another.
+    std::vector<bool> turn_skipped = std::vector<bool>(MAX_PLY + 1);
+
+    SearchContext(const SearchConfig &config, TranspositionTable *transposition_table)
+        : config(config), transposition_table(transposition_table), evaluation_cache(config.evaluation_cache_entries),
+          time_limit(config.deterministic ? 0 : config.seconds) {}
+
+    double elapsed() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // The first iteration always runs to completion so that there is always an action to return.
+    bool should_stop()
+    {
+        if (stop_helpers != nullptr && stop_helpers->load(std::memory_order_relaxed))
+            stopped = true;
+        if (stopped || completed_depth == 0)
+            return stopped;
+
+        if (config.max_nodes != 0 && nodes >= config.max_nodes)
+            stopped = true;
+        else if (time_limit > 0 && (nodes & 1023) == 0 && elapsed() >= time_limit)
+            stopped = true;
+
+        return stopped;
+    }
+};
+
+// Scores the position from the perspective of the side to move.
+inline int32_t get_score(Game &game, int32_t ply)
 {
+    TRACE_ZONE("evaluate");
+
     auto winner = game.check_winner();
     if (winner == Winner::None)
-        return playing_as == Player::Player ? game.player_victory_points - game.opponent_victory_points : game.opponent_victory_points - game.player_victory_points;
-    if (winner == Winner::Player)
-        return 1000 * (playing_as == Player::Player ? 1 : -1);
-    if (winner == Winner::Opponent)
-        return 1000 * (playing_as == Player::Opponent ? 1 : -1);
+        return game.turn == Player::Player ? game.player_victory_points - game.opponent_victory_points : game.opponent_victory_points - game.player_victory_points;
+
+    auto winning_player = winner == Winner::Player ? Player::Player : Player::Opponent;
+    return winning_player == game.turn ? WIN_SCORE - ply : -(WIN_SCORE - ply);
 }
 
-uint32_t search_helper(Game &game, int min, int max, Player playing_as, int depth, int max_depth, std::optional<Attack> &best_attack, std::optional<Move> &best_move)
+// Decided scores are stored relative to the node rather than the root, so that they stay correct when the position is reached at another ply.
+int32_t score_to_transposition_table(int32_t score, int32_t ply)
+{
+    if (score >= WIN_SCORE - MAX_PLY)
+        return score + ply;
+    if (score <= -(WIN_SCORE - MAX_PLY))
+        return score - ply;
+    return score;
+}
+
+int32_t score_from_transposition_table(int32_t score, int32_t ply)
+{
+    if (score >= WIN_SCORE - MAX_PLY)
+        return score - ply;
+    if (score <= -(WIN_SCORE - MAX_PLY))
+        return score + ply;
+    return score;
+}
+
+// Hands out a node's actions a stage at a time, generating each stage only once the ones before it are used up, so
+// that a cutoff early on saves generating the rest. The stages are the preferred action, attacks that gain victory
+// points, the other attacks, ending the turn, moves that neither sprint nor overcharge, and then the moves that do.
+// Attacks come first since they are the only actions that change the score.
+class ActionPicker
+{
+    enum class Stage
+    {
+        Preferred,
+        WinningAttacks,
+        OtherAttacks,
+        EndTurn,
+        QuietMoves,
+        ChargedMoves,
+        // Ending the turn for a side with nothing left to do, even if it has not touched two machines.
+        Pass,
+        Done,
+    };
+
+    Game &game;
+    SearchStats &stats;
+    std::optional<Action> preferred;
+    bool preferred_found = false;
+    const std::vector<Action> &excluded;
+    // Whether the side to move has any attack or move.
+    bool has_action = false;
+    Stage stage = Stage::Preferred;
+    std::vector<SearchMove> actions;
+    size_t next_action = 0;
+    // Generated along with the current stage but handed out in the next one.
+    std::vector<SearchMove> held;
+
+    template <typename Generate>
+    auto timed(GameMachine *machine, Generate generate)
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto generated = generate();
+        auto type = static_cast<int32_t>(MACHINE_TABLE.machine_type[machine->id]);
+        stats.generator_nanoseconds[type] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        ++stats.generator_calls[type];
+        return generated;
+    }
+
+    const std::vector<GameMachine *> &machines() const
+    {
+        return game.turn == Player::Player ? game.player_machines : game.opponent_machines;
+    }
+
+    // Only the preferred action's own machine is generated for, to check that it is legal here.
+    void generate_preferred()
+    {
+        if (!preferred.has_value())
+            return;
+
+        auto action = preferred.value();
+        if (action.type == ActionType::EndTurn)
+        {
+            if (game.can_end_turn())
+                actions.emplace_back(action);
+        }
+        else if (action.type == ActionType::Move || action.type == ActionType::Attack)
+        {
+            auto machine = action.source.out_of_bounds() ? nullptr : game.board->machine_at(action.source);
+            if (machine == nullptr || machine->side != game.turn || !machine->is_alive())
+                return;
+
+            if (action.type == ActionType::Move)
+            {
+                for (const auto &move : timed(machine, [&]
+                                              { return game.calculate_moves(machine); }))
+                {
+                    if (action.matches(move))
+                        actions.emplace_back(move);
+                }
+            }
+            else
+            {
+                for (const auto &attack : timed(machine, [&]
+                                                { return game.calculate_attacks(machine); }))
+                {
+                    if (action.matches(attack))
+                        actions.emplace_back(attack);
+                }
+            }
+        }
+
+        preferred_found = !actions.empty();
+        has_action = preferred_found && action.type != ActionType::EndTurn;
+    }
+
+    // Attacks go in order of their predicted victory points, then the damage they trade, then the margin between the
+    // attacker's combat power and that of the first machine in its path.
+    void generate_attacks()
+    {
+        for (auto machine : machines())
+        {
+            if (!machine->is_alive())
+                continue;
+
+            for (const auto &attack : timed(machine, [&]
+                                            { return game.calculate_attacks(machine); }))
+                held.emplace_back(attack);
+        }
+
+        has_action = has_action || !held.empty();
+        if (held.size() <= 1)
+            return;
+
+        for (auto &search_move : held)
+        {
+            const auto &attack = search_move.attack.value();
+            auto prediction = game.predict_attack(attack);
+            search_move.order = prediction.victory_point_swing(game.turn) * 256 - prediction.damage_taken(game.turn) * 16;
+            search_move.winning = prediction.victory_point_swing(game.turn) > 0;
+            if (!attack.affected_machines.empty())
+                search_move.order += game.combat_power_margin(attack);
+        }
+
+        std::stable_sort(held.begin(), held.end(), [](const SearchMove &a, const SearchMove &b)
+                         { return a.order > b.order; });
+
+        auto winning = std::stable_partition(held.begin(), held.end(), [](const SearchMove &search_move)
+                                             { return search_move.winning; });
+        actions.assign(std::make_move_iterator(held.begin()), std::make_move_iterator(winning));
+        held.erase(held.begin(), winning);
+    }
+
+    void generate_moves()
+    {
+        for (auto machine : machines())
+        {
+            if (!machine->is_alive())
+                continue;
+
+            for (const auto &move : timed(machine, [&]
+                                          { return game.calculate_moves(machine); }))
+            {
+                if (move.causes_state == MachineState::Sprinted || move.causes_state == MachineState::Overcharged)
+                    held.emplace_back(move);
+                else
+                    actions.emplace_back(move);
+            }
+        }
+
+        has_action = has_action || !actions.empty() || !held.empty();
+    }
+
+public:
+    // Actions in excluded are never handed out.
+    ActionPicker(Game &game, SearchStats &stats, std::optional<Action> preferred, const std::vector<Action> &excluded)
+        : game(game), stats(stats), preferred(preferred), excluded(excluded) {}
+
+    // The next action to search, or null once there are none left. Valid until the next call.
+    SearchMove *next()
+    {
+        while (true)
+        {
+            while (next_action < actions.size())
+            {
+                auto &search_move = actions[next_action++];
+                if (std::find(excluded.begin(), excluded.end(), search_move.action) != excluded.end())
+                    continue;
+                if (stage == Stage::Preferred || !preferred_found || !(search_move.action == preferred.value()))
+                    return &search_move;
+            }
+
+            actions.clear();
+            next_action = 0;
+            switch (stage)
+            {
+            case Stage::Preferred:
+                stage = Stage::WinningAttacks;
+                generate_attacks();
+                break;
+            case Stage::WinningAttacks:
+                stage = Stage::OtherAttacks;
+                actions.swap(held);
+                break;
+            case Stage::OtherAttacks:
+                stage = Stage::EndTurn;
+                if (game.can_end_turn())
+                    actions.emplace_back(Action::end_turn());
+                break;
+            case Stage::EndTurn:
+                stage = Stage::QuietMoves;
+                generate_moves();
+                break;
+            case Stage::QuietMoves:
+                stage = Stage::ChargedMoves;
+                actions.swap(held);
+                break;
+            case Stage::ChargedMoves:
+                stage = Stage::Pass;
+                if (!has_action && !game.can_end_turn())
+                    actions.emplace_back(Action::end_turn());
+                break;
+            case Stage::Pass:
+                stage = Stage::Done;
+                break;
+            case Stage::Done:
+                return nullptr;
+            }
+        }
+    }
+
+    // Whether everything still to come is a move.
+    bool only_moves_left() const
+    {
+        return (stage == Stage::EndTurn && next_action >= actions.size()) || stage == Stage::QuietMoves || stage == Stage::ChargedMoves;
+    }
+};
+
+// Scores ending the turn from the tablebase, from the perspective of the side ending it. Empty unless the tablebase
+// knows who wins. Each remaining turn counts as one ply so that faster wins still score higher.
+std::optional<int32_t> probe_tablebase(Game &game, int32_t ply, SearchContext &context)
 {
-    if (depth >= max_depth)
-        return get_score(game, playing_as);
+    if (context.config.tablebase == nullptr)
+        return std::nullopt;
+
+    auto result = context.config.tablebase->probe(game, game.turn == Player::Player ? Player::Opponent : Player::Player);
+    if (!result.has_value() || result->outcome == TablebaseOutcome::Draw)
+        return std::nullopt;
+
+    auto score = WIN_SCORE - std::min(ply + 1 + result->turns, MAX_PLY - 1);
+    return result->outcome == TablebaseOutcome::Win ? -score : score;
+}
 
-    for (auto &machine : game.turn == Player::Player ? game.player_machines : game.opponent_machines)
+// The better of score and the best attack the side to move has.
+int32_t best_attack_score(Game &game, int32_t score, int32_t ply, SearchContext &context)
+{
+    for (auto machine : game.turn == Player::Player ? game.player_machines : game.opponent_machines)
     {
         if (!machine->is_alive())
             continue;
 
-        auto moves = game.calculate_moves(machine);
-        auto attacks = game.calculate_attacks(machine);
+        for (const auto &attack : game.calculate_attacks(machine))
+        {
+            ++context.stats.at_ply(ply).quiescence_nodes;
+            auto prediction = game.predict_attack(attack);
+            auto own = (game.turn == Player::Player ? game.player_victory_points : game.opponent_victory_points) +
+                       (game.turn == Player::Player ? prediction.player_victory_points : prediction.opponent_victory_points);
+            auto other = (game.turn == Player::Player ? game.opponent_victory_points : game.player_victory_points) +
+                         (game.turn == Player::Player ? prediction.opponent_victory_points : prediction.player_victory_points);
+
+            // Matches check_winner, where the side to move wins if both reach 7.
+            if (own >= 7)
+                return WIN_SCORE - (ply + 1);
+            if (other < 7)
+                score = std::max(score, own - other);
+        }
+    }
+
+    return score;
+}
 
-        if (game.can_end_turn() && (moves.empty() && attacks.empty()))
+// The score at a leaf: the better of stopping here and the best attack the side to move has, so that a kill sitting
+// just past the horizon is not missed. Attacks are played out with Game::predict_attack rather than searched.
+int32_t quiescence_score(Game &game, int32_t ply, SearchContext &context)
+{
+    auto score = get_score(game, ply);
+    if (!context.config.quiescence)
+        return score;
+
+    // Looking through every attack is what makes a leaf expensive, so the result is cached. Decided scores are kept
+    // relative to the leaf like the transposition table's.
+    uint64_t key = 0;
+    if (context.evaluation_cache.enabled())
+    {
+        key = game.hash();
+        ++context.stats.at_ply(ply).eval_cache_probes;
+        auto cached = context.evaluation_cache.probe(key);
+        if (cached.has_value())
         {
-            game.end_turn();
+            ++context.stats.at_ply(ply).eval_cache_hits;
+            return score_from_transposition_table(cached.value(), ply);
         }
+    }
+
+    score = best_attack_score(game, score, ply, context);
+    if (context.evaluation_cache.enabled())
+        context.evaluation_cache.store(key, score_to_transposition_table(score, ply));
+    return score;
+}
 
-        for (bool should_end_turn : {true && game.can_end_turn(), false})
+void make_search_move(Game &game, SearchMove &search_move)
+{
+    if (search_move.attack.has_value())
+        game.make_attack(search_move.attack.value());
+    else if (search_move.move.has_value())
+        game.make_move(search_move.move.value());
+    else
+        game.end_turn();
+}
+
+int32_t search_helper(Game &game, int32_t alpha, int32_t beta, int32_t depth, int32_t ply, SearchContext &context,
+                      std::optional<Action> preferred_action = std::nullopt)
+{
+    auto &stats = context.stats.at_ply(ply);
+    ++context.nodes;
+    ++stats.nodes;
+    context.principal_variation[ply].clear();
+
+    if (game.check_winner() != Winner::None || ply >= MAX_PLY)
+    {
+        ++stats.leaf_evaluations;
+        return get_score(game, ply);
+    }
+
+    if (depth <= 0)
+    {
+        ++stats.leaf_evaluations;
+        return quiescence_score(game, ply, context);
+    }
+
+    // Entries are kept for the canonical of the position and its mirror, with actions in that canonical frame.
+    uint64_t key = 0;
+    bool mirrored = false;
+    if (context.transposition_table != nullptr)
+    {
+        std::tie(key, mirrored) = game.canonical_hash();
+        ++stats.tt_probes;
+        auto entry = context.transposition_table->probe(key);
+        if (entry.has_value())
         {
-            if (should_end_turn)
+            ++stats.tt_hits;
+            auto entry_action = entry->best_action();
+            if (!preferred_action.has_value() && entry_action.has_value())
+                preferred_action = mirrored ? entry_action->mirrored() : entry_action;
+
+            // The root always searches so that it has an action to return.
+            if (ply > 0 && entry->depth >= depth)
             {
-                game.end_turn();
+                auto score = score_from_transposition_table(entry->score, ply);
+                if (entry->bound == ScoreBound::Exact ||
+                    (entry->bound == ScoreBound::Lower && score >= beta) ||
+                    (entry->bound == ScoreBound::Upper && score <= alpha))
+                    return score;
             }
+        }
+    }
+
+    // No pruning applies once alpha is a decided score, since then the search is about finding the fastest win.
+    auto undecided = std::abs(alpha) < WIN_SCORE - MAX_PLY || alpha == -INFINITE_SCORE;
+
+    // A side cannot pass in Machine Strike, so skipping its turn stands in for the least it could do with it. That only
+    // holds while acting is never worse than not acting, which stops being true when the side is down to one machine:
+    // then it is made to touch that machine twice, and every move or attack left may walk into a kill.
+    if (context.config.null_move_pruning && ply > 0 && depth >= context.config.null_move_depth && undecided &&
+        std::abs(beta) < WIN_SCORE - MAX_PLY && game.state == GameState::TouchFirstMachine && !context.turn_skipped[ply] &&
+        game.get_turn_machine_count() > 1 && get_score(game, ply) >= beta)
+    {
+        ++stats.null_move_searches;
+        Game skipped(game);
+        skipped.end_turn();
+        context.turn_skipped[ply + 1] = true;
+        auto score = -search_helper(skipped, -beta, -beta + 1, depth - 1 - context.config.null_move_reduction, ply + 1, context);
+        context.turn_skipped[ply + 1] = false;
+        if (context.should_stop())
+            return score;
+
+        if (score >= beta)
+        {
+            ++stats.null_move_prunes;
+            // A win that needed the other side to skip its turn is not a real one, so no more than beta is claimed.
+            return score >= WIN_SCORE - MAX_PLY ? beta : score;
+        }
+    }
+
+    static const std::vector<Action> no_actions;
+    ActionPicker picker(game, context.stats, preferred_action, ply == 0 ? context.excluded_root_actions : no_actions);
+    auto can_prune_futile = context.config.futility_pruning && depth == 1 && ply > 0 && undecided;
+    int32_t futility_score = can_prune_futile ? get_score(game, ply) + context.config.futility_margin : 0;
+
+    auto original_alpha = alpha;
+    int32_t best_score = -INFINITE_SCORE;
+    std::optional<Action> best_action;
+    for (size_t i = 0;; ++i)
+    {
+        // Once futility pruning would skip every move that is left they are not generated at all.
+        auto futile = can_prune_futile && futility_score <= alpha;
+        if (futile && i > 0 && picker.only_moves_left())
+        {
+            ++stats.futility_prunes;
+            best_score = std::max(best_score, futility_score);
+            break;
+        }
+
+        auto picked = picker.next();
+        if (picked == nullptr)
+            break;
+        if (ply == 0)
+            context.root_actions = i + 1;
+
+        auto &search_move = *picked;
+        auto quiet = search_move.action.type == ActionType::Move && i > 0;
+
+        if (quiet && futile)
+        {
+            ++stats.futility_prunes;
+            best_score = std::max(best_score, futility_score);
+            continue;
+        }
 
-            int best_score = Player::Player == game.turn ? max : min;
-            for (auto &attack : attacks)
+        auto tablebase_score = search_move.action.type == ActionType::EndTurn ? probe_tablebase(game, ply, context) : std::nullopt;
+
+        // Within a turn the same side keeps moving, so the window and the score only flip when the turn passes.
+        int32_t new_score;
+        if (tablebase_score.has_value())
+        {
+            ++stats.tablebase_hits;
+            new_score = tablebase_score.value();
+            context.principal_variation[ply + 1].clear();
+        }
+        else
+        {
+            Game new_game(game);
+            make_search_move(new_game, search_move);
+
+            auto search_child = [&](int32_t child_depth)
             {
-                Game new_game(game);
-                new_game.make_attack(attack);
-                auto new_score = search_helper(new_game, min, max, playing_as, depth + 1, max_depth, best_attack, best_move);
-                if (game.turn == Player::Player)
-                {
-                    if (new_score > best_score)
-                    {
-                        best_score = new_score;
-                        best_attack = attack;
-                    }
-                    max = std::max(max, best_score);
-                }
-                else
+                if (new_game.turn == game.turn)
+                    return search_helper(new_game, alpha, beta, child_depth, ply + 1, context);
+                return -search_helper(new_game, -beta, -alpha, child_depth, ply + 1, context);
+            };
+
+            auto reduce = context.config.late_move_reductions && quiet && undecided && depth >= context.config.lmr_depth &&
+                          i >= static_cast<size_t>(context.config.lmr_moves);
+            if (reduce)
+            {
+                ++stats.reductions;
+                new_score = search_child(depth - 2);
+                if (new_score > alpha && !context.should_stop())
                 {
-                    if (new_score < best_score)
-                    {
-                        best_score = new_score;
-                        best_attack = attack;
-                    }
-                    min = std::min(min, best_score);
+                    ++stats.re_searches;
+                    new_score = search_child(depth - 1);
                 }
             }
+            else
+            {
+                new_score = search_child(depth - 1);
+            }
+        }
 
-            for (auto &move : moves)
+        if (context.should_stop())
+            return best_score;
+
+        if (new_score > best_score)
+        {
+            best_score = new_score;
+            best_action = search_move.action;
+            if (new_score > alpha)
             {
-                Game new_game(game);
-                new_game.make_move(move);
-                auto new_score = search_helper(new_game, min, max, playing_as, depth + 1, max_depth, best_attack, best_move);
+                alpha = new_score;
+                auto &pv = context.principal_variation[ply];
+                pv.clear();
+                pv.push_back(search_move.action);
+                pv.insert(pv.end(), context.principal_variation[ply + 1].begin(), context.principal_variation[ply + 1].end());
+            }
+        }
 
-                if (game.turn == Player::Player)
-                {
-                    if (new_score > best_score)
-                    {
-                        best_score = new_score;
-                        best_move = move;
-                        best_attack = std::nullopt;
-                    }
-                    max = std::max(max, best_score);
-                }
-                else
-                {
-                    if (new_score < best_score)
-                    {
-                        best_score = new_score;
-                        best_move = move;
-                        best_attack = std::nullopt;
-                    }
-                    min = std::min(min, best_score);
-                }
+        if (alpha >= beta)
+        {
+            ++stats.beta_cutoffs;
+            if (i == 0)
+                ++stats.first_move_cutoffs;
+            break;
+        }
+    }
+
+    // A root searched without some of its actions has no score of its own to store.
+    if (context.transposition_table != nullptr && (ply > 0 || context.excluded_root_actions.empty()))
+    {
+        auto bound = best_score >= beta ? ScoreBound::Lower : best_score > original_alpha ? ScoreBound::Exact
+                                                                                          : ScoreBound::Upper;
+        if (mirrored && best_action.has_value())
+            best_action = best_action->mirrored();
+        context.transposition_table->store(key, depth, score_to_transposition_table(best_score, ply), bound, best_action);
+        ++stats.tt_stores;
+    }
+
+    return best_score;
+}
+
+SearchResult Game::search(const SearchConfig &config)
+{
+    if (config.opening_book != nullptr)
+    {
+        auto [key, mirrored] = canonical_hash();
+        auto entry = config.opening_book->probe(key);
+        auto action = entry.has_value() ? std::optional<Action>(mirrored ? entry->best_action().mirrored() : entry->best_action()) : std::nullopt;
+        if (action.has_value() && is_legal_action(action.value()))
+        {
+            SearchResult result;
+            result.best_action = action;
+            result.score = entry->score;
+            result.depth = entry->depth;
+            result.principal_variation = {action.value()};
+            result.lines = {SearchLine{action.value(), result.score, result.principal_variation}};
+            result.from_book = true;
+            return result;
+        }
+    }
+
+    auto transposition_table = config.deterministic ? nullptr : config.transposition_table;
+    if (transposition_table == nullptr && config.hash_megabytes > 0)
+        transposition_table = std::make_shared<TranspositionTable>(config.hash_megabytes, config.deterministic ? "" : config.hash_file);
+
+    if (transposition_table != nullptr)
+        transposition_table->new_search();
+
+    SearchContext context(config, transposition_table.get());
+    SearchResult result;
+
+    std::optional<TimeManager> time_manager;
+    if (config.clock.has_value() && !config.deterministic)
+    {
+        time_manager.emplace(config.clock.value());
+        // A clock with nothing left still gets a moment rather than no time limit at all.
+        context.time_limit = std::max(time_manager->hard_seconds(), 0.001);
+    }
+
+    // Lazy SMP: helpers search the same iterations with no coordination beyond the table, odd numbered ones starting a
+    // ply deeper so that threads tend to be on different iterations. Only the main thread's results are reported.
+    std::atomic<bool> stop_helpers = false;
+    std::mutex helper_mutex;
+    uint64_t helper_nodes = 0;
+    std::vector<std::thread> helpers;
+    for (int32_t i = 1; i < (config.deterministic ? 1 : config.threads); ++i)
+    {
+        helpers.emplace_back([&, i, game = std::make_unique<Game>(*this)]() mutable
+                             {
+                                 SearchContext helper(config, transposition_table.get());
+                                 helper.stop_helpers = &stop_helpers;
+                                 helper.time_limit = context.time_limit;
+                                 for (int32_t depth = 1 + i % 2; depth <= config.max_depth; ++depth)
+                                 {
+                                     auto score = search_helper(*game, -INFINITE_SCORE, INFINITE_SCORE, depth, 0, helper);
+                                     if (helper.stopped || std::abs(score) >= WIN_SCORE - MAX_PLY)
+                                         break;
+                                     helper.completed_depth = depth;
+                                 }
+
+                                 game.reset();
+                                 ObjectPool<GameMachine>::release_thread_cache();
+                                 ObjectPool<Board>::release_thread_cache();
+
+                                 std::lock_guard lock(helper_mutex);
+                                 helper_nodes += helper.nodes;
+                                 result.stats.merge(helper.stats); });
+    }
+
+    // Each multi-PV line is a full window search of the root without the actions earlier lines took, so every line's
+    // score is exact. Later lines mostly find their positions already in the table from the first.
+    for (int32_t depth = 1; depth <= config.max_depth; ++depth)
+    {
+        std::vector<SearchLine> lines;
+        int32_t score = 0;
+        size_t root_actions = 0;
+        context.excluded_root_actions.clear();
+        for (int32_t line = 0; line < std::max(config.multi_pv, 1); ++line)
+        {
+            auto preferred = line < static_cast<int32_t>(result.lines.size()) ? std::optional<Action>(result.lines[line].action) : std::nullopt;
+            auto line_score = search_helper(*this, -INFINITE_SCORE, INFINITE_SCORE, depth, 0, context, preferred);
+            if (line == 0)
+            {
+                score = line_score;
+                root_actions = context.root_actions;
             }
+            if (context.stopped || context.principal_variation[0].empty())
+                break;
+
+            auto &principal_variation = context.principal_variation[0];
+            lines.push_back(SearchLine{principal_variation.front(), line_score, principal_variation});
+            context.excluded_root_actions.push_back(principal_variation.front());
         }
+
+        if (context.stopped)
+            break;
+
+        // A line that ties with an earlier one can come out ahead of it once searched with more in the table.
+        std::stable_sort(lines.begin(), lines.end(), [](const SearchLine &a, const SearchLine &b)
+                         { return a.score > b.score; });
+        result.lines = lines;
+        result.depth = depth;
+        result.score = lines.empty() ? score : lines.front().score;
+        result.principal_variation = lines.empty() ? std::vector<Action>() : lines.front().principal_variation;
+        if (!lines.empty())
+            result.best_action = lines.front().action;
+        context.completed_depth = depth;
+
+        // Nothing deeper can change a decided game.
+        if (std::abs(result.score) >= WIN_SCORE - MAX_PLY && std::all_of(lines.begin(), lines.end(), [](const SearchLine &line)
+                                                                         { return std::abs(line.score) >= WIN_SCORE - MAX_PLY; }))
+            break;
+
+        if (time_manager.has_value() && result.best_action.has_value() &&
+            !time_manager->next_iteration(result.best_action.value(), result.score, root_actions, context.elapsed()))
+            break;
     }
 
-    return get_score(game, playing_as);
+    stop_helpers = true;
+    for (auto &helper : helpers)
+        helper.join();
+
+    result.nodes = context.nodes + helper_nodes;
+    result.seconds = context.elapsed();
+    result.stats.merge(context.stats);
+
+    // Every game the search copied is gone by now, so the slots they used go back to the shared pools in one go.
+    ObjectPool<GameMachine>::release_thread_cache();
+    ObjectPool<Board>::release_thread_cache();
+    return result;
 }
 
-void Game::search(uint32_t seconds)
+SearchConfig parse_search_config(const std::string &str)
 {
-    std::optional<Attack> best_attack = std::nullopt;
-    std::optional<Move> best_move = std::nullopt;
+    SearchConfig config;
 
-    auto score = search_helper(*this, INT32_MIN, INT32_MAX, turn, 0, 6, best_attack, best_move);
-    printf("Score: %d\n", score);
-}
\ No newline at end of file
+    size_t start = 0;
+    while (start < str.size())
+    {
+        auto end = str.find(',', start);
+        auto entry = str.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        start = end == std::string::npos ? str.size() : end + 1;
+
+        auto separator = entry.find('=');
+        if (separator == std::string::npos)
+            throw std::runtime_error("Invalid search option " + entry);
+
+        auto key = entry.substr(0, separator);
+        auto value = entry.substr(separator + 1);
+
+        if (key == "seconds")
+            config.seconds = std::stod(value);
+        else if (key == "nodes")
+            config.max_nodes = std::stoull(value);
+        else if (key == "time" || key == "increment" || key == "actions")
+        {
+            auto &clock = config.clock.has_value() ? config.clock.value() : config.clock.emplace();
+            if (key == "time")
+                clock.remaining_seconds = std::stod(value);
+            else if (key == "increment")
+                clock.increment_seconds = std::stod(value);
+            else
+                clock.actions_played = std::stoi(value);
+        }
+        else if (key == "deterministic")
+            config.deterministic = std::stoi(value) != 0;
+        else if (key == "depth")
+            config.max_depth = std::stoi(value);
+        else if (key == "hash")
+            config.hash_megabytes = std::stoull(value);
+        else if (key == "hashfile")
+            config.hash_file = value;
+        else if (key == "threads")
+            config.threads = std::stoi(value);
+        else if (key == "multipv")
+            config.multi_pv = std::stoi(value);
+        else if (key == "quiescence")
+            config.quiescence = std::stoi(value) != 0;
+        else if (key == "evalcache")
+            config.evaluation_cache_entries = std::stoull(value);
+        else if (key == "futility")
+            config.futility_pruning = std::stoi(value) != 0;
+        else if (key == "futilitymargin")
+            config.futility_margin = std::stoi(value);
+        else if (key == "lmr")
+            config.late_move_reductions = std::stoi(value) != 0;
+        else if (key == "lmrdepth")
+            config.lmr_depth = std::stoi(value);
+        else if (key == "lmrmoves")
+            config.lmr_moves = std::stoi(value);
+        else if (key == "nullmove")
+            config.null_move_pruning = std::stoi(value) != 0;
+        else if (key == "nullmovedepth")
+            config.null_move_depth = std::stoi(value);
+        else if (key == "nullmovereduction")
+            config.null_move_reduction = std::stoi(value);
+        else
+            throw std::runtime_error("Unknown search option " + key);
+    }
+
+    return config;
+}
+
+std::string search_config_to_string(const SearchConfig &config)
+{
+    std::ostringstream str;
+    str << "seconds=" << config.seconds
+        << ",nodes=" << config.max_nodes
+        << ",deterministic=" << (config.deterministic ? 1 : 0)
+        << ",depth=" << config.max_depth
+        << ",hash=" << config.hash_megabytes
+        << ",threads=" << config.threads
+        << ",multipv=" << config.multi_pv
+        << ",quiescence=" << (config.quiescence ? 1 : 0)
+        << ",evalcache=" << config.evaluation_cache_entries
+        << ",futility=" << (config.futility_pruning ? 1 : 0)
+        << ",futilitymargin=" << config.futility_margin
+        << ",lmr=" << (config.late_move_reductions ? 1 : 0)
+        << ",lmrdepth=" << config.lmr_depth
+        << ",lmrmoves=" << config.lmr_moves
+        << ",nullmove=" << (config.null_move_pruning ? 1 : 0)
+        << ",nullmovedepth=" << config.null_move_depth
+        << ",nullmovereduction=" << config.null_move_reduction;
+    if (!config.hash_file.empty())
+        str << ",hashfile=" << config.hash_file;
+    if (config.clock.has_value())
+        str << ",time=" << config.clock->remaining_seconds << ",increment=" << config.clock->increment_seconds << ",actions=" << config.clock->actions_played;
+    return str.str();
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "action.h"
+#include "search_stats.h"
+#include "time_manager.h"
+#include "transposition_table.h"
+
+class Tablebase;
+class OpeningBook;
+
+// Any score at or beyond this magnitude is a decided game.
+constexpr int32_t WIN_SCORE = 1000;
+
+class SearchConfig
+{
+public:
+    // Wall clock budget for the whole search. Zero means no time limit.
+    double seconds = 5;
+    // If set, a TimeManager budgets the search from the side to move's clock instead, and seconds is ignored.
+    std::optional<GameClock> clock;
+    // Node budget for the whole search. Zero means no node limit.
+    uint64_t max_nodes = 0;
+    // Whether the search must come out the same every time for the same position and config, for benchmarking with a
+    // node budget. Ignores seconds, clock and threads, and searches with a fresh table of hash_megabytes in memory instead of
+    // transposition_table or hash_file, since what an earlier search left there would change the result.
+    bool deterministic = false;
+    // The deepest iteration to run, in actions.
+    int32_t max_depth = 64;
+    // Size of the transposition table. Zero disables it.
+    size_t hash_megabytes = 16;
+    // If set, the transposition table is kept in this file so that it survives between sessions.
+    std::string hash_file;
+    // The table to search with. If empty, a table of hash_megabytes is made for this search alone.
+    std::shared_ptr<TranspositionTable> transposition_table;
+    // Threads searching the position together. Helpers run the same iterations on their own copy of the game, some of
+    // them a ply deeper, and only pass on what they learn through the shared transposition table.
+    int32_t threads = 1;
+    // How many of the best root actions to report, each with its own exact score and principal variation.
+    int32_t multi_pv = 1;
+    // If set, positions it covers are scored exactly whenever a turn ends.
+    std::shared_ptr<const Tablebase> tablebase;
+    // If set, a position found in the book is answered from it without searching.
+    std::shared_ptr<const OpeningBook> opening_book;
+    // Whether leaves also consider the best attack the side to move has, played out by Game::predict_attack.
+    bool quiescence = true;
+    // Entries in each search thread's cache of leaf scores. Zero disables it.
+    size_t evaluation_cache_entries = 1 << 16;
+    // Whether moves one action from the horizon are skipped when the static score plus futility_margin cannot reach alpha.
+    // Moves never change the score by themselves, so the margin only has to cover the attack a leaf may still find.
+    bool futility_pruning = true;
+    int32_t futility_margin = 3;
+    // Whether moves after the first lmr_moves at a node at least lmr_depth deep are searched one action shallower first,
+    // and again at full depth if they beat alpha.
+    bool late_move_reductions = true;
+    int32_t lmr_depth = 3;
+    int32_t lmr_moves = 4;
+    // Whether a node at least null_move_depth deep at the start of a turn first lets the other side take a turn in its
+    // place, searched null_move_reduction actions shallower, and is pruned if the side to move still stays at or above
+    // beta. Skipped when the side to move is down to one machine, since then having to act can be what loses.
+    // A turn is usually four actions, two machines moving and attacking, so that is what skipping one saves by default.
+    // Off until a selfplay SPRT run accepts it.
+    bool null_move_pruning = false;
+    int32_t null_move_depth = 3;
+    int32_t null_move_reduction = 4;
+};
+
+// Parses a comma separated list of key=value pairs, e.g. "seconds=0.5,depth=6", on top of the defaults.
+// Throws on unknown keys or malformed values.
+SearchConfig parse_search_config(const std::string &str);
+std::string search_config_to_string(const SearchConfig &config);
+
+// One of the best root actions found by a multi-PV search.
+class SearchLine
+{
+public:
+    Action action;
+    // From the perspective of the side to move.
+    int32_t score = 0;
+    std::vector<Action> principal_variation;
+};
+
+class SearchResult
+{
+public:
+    // Empty if the side to move has no legal action.
+    std::optional<Action> best_action;
+    // From the perspective of the side to move.
+    int32_t score = 0;
+    // The deepest fully completed iteration.
+    int32_t depth = 0;
+    uint64_t nodes = 0;
+    double seconds = 0;
+    std::vector<Action> principal_variation;
+    // The best SearchConfig::multi_pv root actions, best first, from the deepest completed iteration. The first is the
+    // same as best_action. Fewer if the side to move has fewer legal actions.
+    std::vector<SearchLine> lines;
+    SearchStats stats;
+    // True if the action came from the opening book, in which case score and depth are the book's.
+    bool from_book = false;
+};
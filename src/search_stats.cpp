@@ -0,0 +1,111 @@
+#include <cstdio>
+#include <sstream>
+#include "search_stats.h"
+
+static const char *MACHINE_TYPE_NAMES[MACHINE_TYPE_COUNT] = {"Gunner", "Pull", "Ram", "Melee", "Dash", "Swoop"};
+
+void PlyStats::merge(const PlyStats &other)
+{
+    nodes += other.nodes;
+    leaf_evaluations += other.leaf_evaluations;
+    beta_cutoffs += other.beta_cutoffs;
+    first_move_cutoffs += other.first_move_cutoffs;
+    tt_probes += other.tt_probes;
+    tt_hits += other.tt_hits;
+    tt_stores += other.tt_stores;
+    quiescence_nodes += other.quiescence_nodes;
+    eval_cache_probes += other.eval_cache_probes;
+    eval_cache_hits += other.eval_cache_hits;
+    tablebase_hits += other.tablebase_hits;
+    futility_prunes += other.futility_prunes;
+    reductions += other.reductions;
+    re_searches += other.re_searches;
+    null_move_searches += other.null_move_searches;
+    null_move_prunes += other.null_move_prunes;
+}
+
+void SearchStats::merge(const SearchStats &other)
+{
+    for (int32_t ply = 0; ply < MAX_STATS_PLY; ++ply)
+        plies[ply].merge(other.plies[ply]);
+
+    for (int32_t type = 0; type < MACHINE_TYPE_COUNT; ++type)
+    {
+        generator_nanoseconds[type] += other.generator_nanoseconds[type];
+        generator_calls[type] += other.generator_calls[type];
+    }
+}
+
+PlyStats SearchStats::total() const
+{
+    PlyStats total;
+    for (const auto &ply : plies)
+        total.merge(ply);
+
+    return total;
+}
+
+static double percent(uint64_t numerator, uint64_t denominator)
+{
+    return denominator == 0 ? 0 : 100.0 * numerator / denominator;
+}
+
+static void append_row(std::ostringstream &str, const char *label, const PlyStats &stats)
+{
+    char line[256];
+    snprintf(line, sizeof(line), "%6s %12llu %12llu %12llu %9.1f%% %12llu %9.1f%% %12llu %12llu %9.1f%% %12llu %12llu %12llu %12llu %12llu %12llu\n",
+             label,
+             static_cast<unsigned long long>(stats.nodes),
+             static_cast<unsigned long long>(stats.leaf_evaluations),
+             static_cast<unsigned long long>(stats.beta_cutoffs),
+             percent(stats.first_move_cutoffs, stats.beta_cutoffs),
+             static_cast<unsigned long long>(stats.tt_probes),
+             percent(stats.tt_hits, stats.tt_probes),
+             static_cast<unsigned long long>(stats.tt_stores),
+             static_cast<unsigned long long>(stats.quiescence_nodes),
+             percent(stats.eval_cache_hits, stats.eval_cache_probes),
+             static_cast<unsigned long long>(stats.tablebase_hits),
+             static_cast<unsigned long long>(stats.futility_prunes),
+             static_cast<unsigned long long>(stats.reductions),
+             static_cast<unsigned long long>(stats.re_searches),
+             static_cast<unsigned long long>(stats.null_move_searches),
+             static_cast<unsigned long long>(stats.null_move_prunes));
+    str << line;
+}
+
+std::string SearchStats::to_string() const
+{
+    std::ostringstream str;
+    char line[256];
+
+    snprintf(line, sizeof(line), "%6s %12s %12s %12s %10s %12s %10s %12s %12s %10s %12s %12s %12s %12s %12s %12s\n", "Ply", "Nodes", "Leaves", "Cutoffs", "First", "TT probes", "TT hits", "TT stores", "QNodes", "Eval hits", "TB hits", "Futile", "Reduced", "Re-searched", "Skips", "Skip cuts");
+    str << line;
+
+    for (int32_t ply = 0; ply < MAX_STATS_PLY; ++ply)
+    {
+        if (plies[ply].nodes == 0 && plies[ply].quiescence_nodes == 0)
+            continue;
+
+        auto label = ply == MAX_STATS_PLY - 1 ? std::to_string(ply) + "+" : std::to_string(ply);
+        append_row(str, label.c_str(), plies[ply]);
+    }
+
+    append_row(str, "Total", total());
+
+    snprintf(line, sizeof(line), "\n%8s %12s %12s %10s\n", "Type", "Calls", "Millis", "Nanos/call");
+    str << line;
+    for (int32_t type = 0; type < MACHINE_TYPE_COUNT; ++type)
+    {
+        if (generator_calls[type] == 0)
+            continue;
+
+        snprintf(line, sizeof(line), "%8s %12llu %12.1f %10llu\n",
+                 MACHINE_TYPE_NAMES[type],
+                 static_cast<unsigned long long>(generator_calls[type]),
+                 generator_nanoseconds[type] / 1e6,
+                 static_cast<unsigned long long>(generator_nanoseconds[type] / generator_calls[type]));
+        str << line;
+    }
+
+    return str.str();
+}
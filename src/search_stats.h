@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// Deeper plies are folded into the last bucket.
+constexpr int32_t MAX_STATS_PLY = 32;
+constexpr int32_t MACHINE_TYPE_COUNT = 6;
+
+class PlyStats
+{
+public:
+    uint64_t nodes = 0;
+    uint64_t leaf_evaluations = 0;
+    uint64_t beta_cutoffs = 0;
+    // Cutoffs caused by the first action searched at the node.
+    uint64_t first_move_cutoffs = 0;
+    uint64_t tt_probes = 0;
+    uint64_t tt_hits = 0;
+    uint64_t tt_stores = 0;
+    uint64_t quiescence_nodes = 0;
+    // Leaf scores looked up in the evaluation cache, and how many of them were found.
+    uint64_t eval_cache_probes = 0;
+    uint64_t eval_cache_hits = 0;
+    uint64_t tablebase_hits = 0;
+    // Moves skipped by futility pruning (counting the moves a node never generated as one), moves searched at reduced
+    // depth, and reduced moves searched again at full depth.
+    uint64_t futility_prunes = 0;
+    uint64_t reductions = 0;
+    uint64_t re_searches = 0;
+    // Turns skipped to see whether a node is good enough to prune without searching it, and the nodes that were.
+    uint64_t null_move_searches = 0;
+    uint64_t null_move_prunes = 0;
+
+    void merge(const PlyStats &other);
+};
+
+// Counters for one search. Every search thread fills in its own copy with plain increments,
+// and the copies are merged once the search is over.
+class SearchStats
+{
+public:
+    std::array<PlyStats, MAX_STATS_PLY> plies{};
+    // Time spent in calculate_moves and calculate_attacks, indexed by MachineType. Each call to either counts.
+    std::array<uint64_t, MACHINE_TYPE_COUNT> generator_nanoseconds{};
+    std::array<uint64_t, MACHINE_TYPE_COUNT> generator_calls{};
+
+    PlyStats &at_ply(int32_t ply)
+    {
+        return plies[ply < MAX_STATS_PLY ? ply : MAX_STATS_PLY - 1];
+    }
+
+    void merge(const SearchStats &other);
+    PlyStats total() const;
+    // A per ply table followed by the generator times, for the REPL.
+    std::string to_string() const;
+};
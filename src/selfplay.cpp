@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "selfplay.h"
+#include "game_record.h"
+#include "machine_definitions.h"
+
+Game random_starting_position(std::mt19937 &rng, int32_t max_points)
+{
+    // Chasm, Marsh, Grassland, Forest, Hill, Mountain
+    std::discrete_distribution<int32_t> terrain_distribution({4, 8, 30, 28, 20, 10});
+
+    // The board is point symmetric so that both sides face the same terrain.
+    BoardType<Terrain> terrain;
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int column = 0; column < 8; ++column)
+        {
+            auto value = static_cast<Terrain>(terrain_distribution(rng) + static_cast<int32_t>(Terrain::Chasm));
+            terrain[{row, column}] = value;
+            terrain[{7 - row, 7 - column}] = value;
+        }
+    }
+
+    std::vector<int32_t> ids(ALL_MACHINES.size());
+    std::iota(ids.begin(), ids.end(), 0);
+    std::shuffle(ids.begin(), ids.end(), rng);
+
+    std::vector<Coord> spaces;
+    for (int row = 6; row < 8; ++row)
+    {
+        for (int column = 0; column < 8; ++column)
+        {
+            if (terrain[{row, column}] != Terrain::Chasm)
+                spaces.push_back({row, column});
+        }
+    }
+
+    std::shuffle(spaces.begin(), spaces.end(), rng);
+
+    BoardType<std::optional<GameMachine>> machines{std::nullopt};
+    int32_t points = 0;
+    size_t placed = 0;
+    for (auto id : ids)
+    {
+        const auto &machine = ALL_MACHINES[id].get();
+        if (points + machine.points > max_points || placed == spaces.size())
+            continue;
+
+        auto space = spaces[placed++];
+        Coord mirrored{7 - space.row, 7 - space.column};
+        machines[space] = GameMachine(ALL_MACHINES[id], MachineDirection::North, space, MachineState::Ready, Player::Player);
+        machines[mirrored] = GameMachine(ALL_MACHINES[id], MachineDirection::South, mirrored, MachineState::Ready, Player::Opponent);
+        points += machine.points;
+    }
+
+    return Game(machines, terrain, Player::Player);
+}
+
+// Plays one game to the end and returns the winner, or Winner::None if it was drawn by the action limit.
+// An engine with a clock loses the game if its searches use up the time on it.
+static Winner play_game(Game &game, SearchConfig player_config, SearchConfig opponent_config, uint32_t max_actions, GameRecord &record)
+{
+    for (uint32_t actions = 0; actions < max_actions && game.check_winner() == Winner::None; ++actions)
+    {
+        auto &config = game.turn == Player::Player ? player_config : opponent_config;
+        auto result = game.search(config);
+        auto action = result.best_action.value_or(Action::end_turn());
+
+        if (config.clock.has_value())
+        {
+            auto &clock = config.clock.value();
+            clock.remaining_seconds -= result.seconds;
+            if (clock.remaining_seconds < 0)
+            {
+                record.result = game.turn == Player::Player ? Winner::Opponent : Winner::Player;
+                return record.result;
+            }
+
+            clock.remaining_seconds += clock.increment_seconds;
+            ++clock.actions_played;
+        }
+
+        record.add_action(action);
+        game.make_action(action);
+    }
+
+    record.result = game.check_winner();
+    return record.result;
+}
+
+double TournamentResult::score() const
+{
+    return games() == 0 ? 0.5 : (wins + 0.5 * draws) / games();
+}
+
+static double score_to_elo(double score)
+{
+    score = std::clamp(score, 1e-6, 1 - 1e-6);
+    return -400 * std::log10(1 / score - 1);
+}
+
+static double elo_to_score(double elo)
+{
+    return 1 / (1 + std::pow(10, -elo / 400));
+}
+
+// Per game variance of the candidate's score.
+static double score_variance(const TournamentResult &result)
+{
+    if (result.games() == 0)
+        return 0;
+
+    auto score = result.score();
+    auto n = static_cast<double>(result.games());
+    return (result.wins * std::pow(1 - score, 2) + result.draws * std::pow(0.5 - score, 2) + result.losses * std::pow(score, 2)) / n;
+}
+
+double TournamentResult::elo() const
+{
+    return score_to_elo(score());
+}
+
+double TournamentResult::elo_error() const
+{
+    if (games() == 0)
+        return 0;
+
+    auto margin = 1.96 * std::sqrt(score_variance(*this) / games());
+    return (score_to_elo(std::min(score() + margin, 1.0)) - score_to_elo(std::max(score() - margin, 0.0))) / 2;
+}
+
+double SprtConfig::lower_bound() const
+{
+    return std::log(beta / (1 - alpha));
+}
+
+double SprtConfig::upper_bound() const
+{
+    return std::log((1 - beta) / alpha);
+}
+
+std::string TournamentResult::verdict() const
+{
+    if (llr >= upper_bound)
+        return "H1";
+    if (llr <= lower_bound)
+        return "H0";
+    return "-";
+}
+
+// The log-likelihood ratio of elo1 against elo0, using the normal approximation of the trinomial
+// game outcome distribution (the generalized SPRT).
+double log_likelihood_ratio(const TournamentResult &result, const SprtConfig &sprt)
+{
+    auto variance = score_variance(result);
+    if (result.games() == 0 || variance <= 0)
+        return 0;
+
+    auto score0 = elo_to_score(sprt.elo0);
+    auto score1 = elo_to_score(sprt.elo1);
+    return result.games() * (score1 - score0) * (2 * result.score() - score0 - score1) / (2 * variance);
+}
+
+TournamentResult run_tournament(const TournamentConfig &config)
+{
+    TournamentResult result;
+    result.lower_bound = config.sprt.lower_bound();
+    result.upper_bound = config.sprt.upper_bound();
+
+    if (!config.record_directory.empty())
+        std::filesystem::create_directories(config.record_directory);
+
+    std::mutex result_mutex;
+    std::atomic<uint32_t> next_pair = 0;
+    std::atomic<bool> finished = false;
+    auto start = std::chrono::steady_clock::now();
+    auto pairs = (config.max_games + 1) / 2;
+
+    auto worker = [&]()
+    {
+        // Each engine keeps its own transposition table across the searches of a game.
+        auto candidate = config.candidate;
+        auto baseline = config.baseline;
+        for (auto engine : {&candidate, &baseline})
+        {
+            if (engine->transposition_table == nullptr && engine->hash_megabytes > 0)
+                engine->transposition_table = std::make_shared<TranspositionTable>(engine->hash_megabytes);
+        }
+
+        for (auto pair = next_pair++; pair < pairs && !finished; pair = next_pair++)
+        {
+            std::mt19937 rng(config.seed + pair);
+            auto starting_position = random_starting_position(rng);
+
+            // The candidate plays the player side in the first game of the pair and the opponent side in the second.
+            for (auto candidate_side : {Player::Player, Player::Opponent})
+            {
+                for (auto engine : {&candidate, &baseline})
+                {
+                    if (engine->transposition_table != nullptr)
+                        engine->transposition_table->clear();
+                }
+
+                Game game(starting_position);
+                GameRecord record(game);
+                auto winner = candidate_side == Player::Player
+                                  ? play_game(game, candidate, baseline, config.max_actions, record)
+                                  : play_game(game, baseline, candidate, config.max_actions, record);
+
+                if (!config.record_directory.empty())
+                    record.save((std::filesystem::path(config.record_directory) / ("game_" + std::to_string(pair * 2 + (candidate_side == Player::Player ? 0 : 1)) + ".msr")).string());
+
+                std::lock_guard lock(result_mutex);
+                if (winner == Winner::None)
+                    ++result.draws;
+                else if ((winner == Winner::Player) == (candidate_side == Player::Player))
+                    ++result.wins;
+                else
+                    ++result.losses;
+
+                result.llr = log_likelihood_ratio(result, config.sprt);
+                if (result.verdict() != "-" || result.games() >= config.max_games)
+                    finished = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (uint32_t i = 0; i < std::max(config.threads, 1u); ++i)
+        workers.emplace_back(worker);
+    for (auto &thread : workers)
+        thread.join();
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+std::string tournament_summary(const TournamentConfig &config, const TournamentResult &result)
+{
+    char line[256];
+    std::ostringstream summary;
+
+    summary << "Candidate: " << search_config_to_string(config.candidate) << "\n";
+    summary << "Baseline:  " << search_config_to_string(config.baseline) << "\n";
+    snprintf(line, sizeof(line), "SPRT:      elo0=%.1f elo1=%.1f alpha=%.3f beta=%.3f\n", config.sprt.elo0, config.sprt.elo1, config.sprt.alpha, config.sprt.beta);
+    summary << line;
+    snprintf(line, sizeof(line), "%8s %6s %6s %6s %8s %16s %8s %18s %8s %9s\n", "Games", "Wins", "Draws", "Losses", "Score", "Elo", "LLR", "Bounds", "Verdict", "Seconds");
+    summary << line;
+    snprintf(line, sizeof(line), "%8u %6u %6u %6u %7.1f%% %8.1f +- %5.1f %8.3f [%7.3f, %6.3f] %8s %9.1f\n",
+             result.games(), result.wins, result.draws, result.losses, result.score() * 100, result.elo(), result.elo_error(),
+             result.llr, result.lower_bound, result.upper_bound, result.verdict().c_str(), result.seconds);
+    summary << line;
+
+    return summary.str();
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include "game.h"
+#include "search.h"
+
+// Builds a random starting position: random terrain, and for each side a random set of machines worth
+// at most max_points placed facing forward on that side's two home rows. The opponent's setup mirrors
+// the player's so that neither side starts with a material edge.
+Game random_starting_position(std::mt19937 &rng, int32_t max_points = 10);
+
+class SprtConfig
+{
+public:
+    // The null and alternative hypotheses, in Elo of the candidate over the baseline.
+    double elo0 = 0;
+    double elo1 = 10;
+    // False positive and false negative rates.
+    double alpha = 0.05;
+    double beta = 0.05;
+
+    // The log-likelihood ratios at or below which H0 is accepted, and at or above which H1 is.
+    double lower_bound() const;
+    double upper_bound() const;
+};
+
+class TournamentConfig
+{
+public:
+    SearchConfig candidate;
+    SearchConfig baseline;
+    SprtConfig sprt;
+    // Games are played in pairs from the same starting position with the engines swapping sides.
+    uint32_t max_games = 1000;
+    uint32_t threads = 1;
+    // A game that reaches this many actions without a winner is a draw.
+    uint32_t max_actions = 600;
+    uint32_t seed = 1;
+    // If set, every finished game is written to this directory as a game record.
+    std::string record_directory;
+};
+
+class TournamentResult
+{
+public:
+    // From the candidate's point of view.
+    uint32_t wins = 0;
+    uint32_t draws = 0;
+    uint32_t losses = 0;
+    double llr = 0;
+    double lower_bound = 0;
+    double upper_bound = 0;
+    double seconds = 0;
+
+    uint32_t games() const { return wins + draws + losses; }
+    double score() const;
+    double elo() const;
+    // Half width of the 95% confidence interval around elo().
+    double elo_error() const;
+    // "H1" if the candidate is accepted as stronger, "H0" if rejected, or "-" if the test did not finish.
+    std::string verdict() const;
+};
+
+// The log-likelihood ratio of sprt.elo1 against sprt.elo0 given the games played so far. Zero before there is any
+// spread in the results.
+double log_likelihood_ratio(const TournamentResult &result, const SprtConfig &sprt);
+
+// Plays candidate against baseline until the SPRT accepts one hypothesis or max_games is reached.
+TournamentResult run_tournament(const TournamentConfig &config);
+
+std::string tournament_summary(const TournamentConfig &config, const TournamentResult &result);
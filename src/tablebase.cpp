@@ -0,0 +1,485 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+#include "tablebase.h"
+#include "machine_definitions.h"
+#include "machine_table.h"
+#include "trace.h"
+#include "utils.h"
+
+constexpr uint8_t TABLEBASE_VERSION = 1;
+constexpr size_t TABLEBASE_HEADER_SIZE = 96;
+constexpr uint64_t TABLEBASE_CHUNK_SIZE = 4096;
+
+// Stored values. Anything else is ((turns << 1) | is_loss) + 1.
+constexpr uint16_t UNRESOLVED_VALUE = 0;
+constexpr uint16_t INVALID_VALUE = 0xFFFF;
+
+static uint16_t encode_value(TablebaseOutcome outcome, int32_t turns)
+{
+    return static_cast<uint16_t>(((std::min(turns, 0x7FFE) << 1) | (outcome == TablebaseOutcome::Loss ? 1 : 0)) + 1);
+}
+
+static TablebaseResult decode_value(uint16_t value)
+{
+    if (value == UNRESOLVED_VALUE)
+        return {};
+
+    value -= 1;
+    return {value & 1 ? TablebaseOutcome::Loss : TablebaseOutcome::Win, value >> 1};
+}
+
+static uint16_t read_value(const uint8_t *values, uint64_t index)
+{
+    return static_cast<uint16_t>(values[index * 2] | (values[index * 2 + 1] << 8));
+}
+
+static void write_value(uint8_t *values, uint64_t index, uint16_t value)
+{
+    values[index * 2] = static_cast<uint8_t>(value);
+    values[index * 2 + 1] = static_cast<uint8_t>(value >> 8);
+}
+
+static Player other_side(Player side)
+{
+    return side == Player::Player ? Player::Opponent : Player::Player;
+}
+
+static bool same_kind(const TablebaseMachine &a, const TablebaseMachine &b)
+{
+    return a.id == b.id && a.side == b.side;
+}
+
+TablebaseLayout::TablebaseLayout(const BoardType<Terrain> &terrain, const std::vector<TablebaseMachine> &machines, int32_t player_base_victory_points, int32_t opponent_base_victory_points)
+    : terrain(terrain), machines(machines), player_base_victory_points(player_base_victory_points), opponent_base_victory_points(opponent_base_victory_points)
+{
+    for (size_t slot = 0; slot < machines.size(); ++slot)
+    {
+        auto flying = ALL_MACHINES[machines[slot].id].get().is_flying();
+        auto &indices = space_indices.emplace_back();
+        auto &slot_spaces = spaces.emplace_back();
+        for (int32_t space = 0; space < 64; ++space)
+        {
+            auto standable = flying || terrain.data[space / 8][space % 8] != Terrain::Chasm;
+            indices[space] = standable ? static_cast<int32_t>(slot_spaces.size()) : -1;
+            if (standable)
+                slot_spaces.push_back(space);
+        }
+
+        strides.push_back(position_count);
+        position_count *= state_count(slot);
+    }
+}
+
+uint64_t TablebaseLayout::state_count(size_t slot) const
+{
+    return spaces[slot].size() * 4 * static_cast<uint64_t>(machines[slot].max_health) + 1;
+}
+
+std::optional<uint64_t> TablebaseLayout::index_of(const Game &game, Player to_move, bool mirror) const
+{
+    for (int32_t row = 0; row < 8; ++row)
+    {
+        for (int32_t column = 0; column < 8; ++column)
+        {
+            if (game.board->terrain->spaces.data[row][mirror ? 7 - column : column] != terrain.data[row][column])
+                return std::nullopt;
+        }
+    }
+
+    std::array<uint64_t, MAX_TABLEBASE_MACHINES> states{};
+    for (auto side_machines : {&game.player_machines, &game.opponent_machines})
+    {
+        for (auto machine : *side_machines)
+        {
+            if (!machine->is_alive())
+                continue;
+
+            auto id = machine->id;
+            size_t slot = 0;
+            while (slot < machines.size() && (states[slot] != 0 || machines[slot].id != id || machines[slot].side != machine->side || machine->health > machines[slot].max_health))
+                ++slot;
+            if (slot == machines.size())
+                return std::nullopt;
+
+            auto coordinates = mirror ? mirror_coord(machine->coordinates) : machine->coordinates;
+            auto direction = mirror ? mirror_direction(machine->direction) : machine->direction;
+            auto space = space_indices[slot][coordinates.row * 8 + coordinates.column];
+            if (space < 0)
+                return std::nullopt;
+
+            states[slot] = 1 + (static_cast<uint64_t>(space) * 4 + static_cast<uint64_t>(direction)) * machines[slot].max_health + (machine->health - 1);
+        }
+    }
+
+    int32_t player_victory_points = player_base_victory_points;
+    int32_t opponent_victory_points = opponent_base_victory_points;
+    for (size_t slot = 0; slot < machines.size(); ++slot)
+    {
+        if (states[slot] == 0)
+            (machines[slot].side == Player::Player ? opponent_victory_points : player_victory_points) += ALL_MACHINES[machines[slot].id].get().points;
+    }
+
+    if (player_victory_points != game.player_victory_points || opponent_victory_points != game.opponent_victory_points)
+        return std::nullopt;
+
+    for (size_t slot = 0; slot + 1 < machines.size(); ++slot)
+    {
+        if (same_kind(machines[slot], machines[slot + 1]) && states[slot] > states[slot + 1])
+            std::swap(states[slot], states[slot + 1]);
+    }
+
+    uint64_t index = to_move == Player::Player ? 0 : 1;
+    for (size_t slot = 0; slot < machines.size(); ++slot)
+        index += states[slot] * strides[slot];
+
+    return index;
+}
+
+std::optional<Game> TablebaseLayout::game_at(uint64_t index) const
+{
+    auto to_move = index % 2 == 0 ? Player::Player : Player::Opponent;
+    index /= 2;
+
+    BoardType<std::optional<GameMachine>> board_machines{std::nullopt};
+    int32_t player_victory_points = player_base_victory_points;
+    int32_t opponent_victory_points = opponent_base_victory_points;
+    uint64_t previous_state = 0;
+    for (size_t slot = 0; slot < machines.size(); ++slot)
+    {
+        const auto &machine = machines[slot];
+        auto state = index % state_count(slot);
+        index /= state_count(slot);
+
+        if (slot > 0 && same_kind(machines[slot - 1], machine) && previous_state > state)
+            return std::nullopt;
+        previous_state = state;
+
+        if (state == 0)
+        {
+            (machine.side == Player::Player ? opponent_victory_points : player_victory_points) += ALL_MACHINES[machine.id].get().points;
+            continue;
+        }
+
+        auto health = static_cast<int32_t>((state - 1) % machine.max_health) + 1;
+        auto direction = static_cast<MachineDirection>((state - 1) / machine.max_health % 4);
+        auto space = spaces[slot][(state - 1) / machine.max_health / 4];
+        Coord coordinates{space / 8, space % 8};
+
+        auto &board_machine = board_machines[coordinates];
+        if (board_machine.has_value())
+            return std::nullopt;
+
+        board_machine = GameMachine(ALL_MACHINES[machine.id], direction, coordinates, MachineState::Ready, machine.side);
+        board_machine->health = health;
+    }
+
+    Game game(board_machines, terrain, other_side(to_move));
+    game.player_victory_points = player_victory_points;
+    game.opponent_victory_points = opponent_victory_points;
+    if (game.check_winner() != Winner::None)
+        return std::nullopt;
+
+    game.end_turn();
+    return game;
+}
+
+// What the side to move can reach by the end of its turn, given what is already solved.
+class TurnOutcomes
+{
+public:
+    std::optional<int32_t> fastest_win;
+    int32_t slowest_loss = 0;
+    bool has_unresolved = false;
+    std::unordered_set<uint64_t> visited;
+};
+
+static void expand_turn(Game &game, const TablebaseLayout &layout, const uint8_t *values, TurnOutcomes &outcomes)
+{
+    if (outcomes.fastest_win.has_value() || !outcomes.visited.insert(game.hash()).second)
+        return;
+
+    std::vector<Attack> attacks;
+    std::vector<Move> moves;
+    for (auto machine : game.turn == Player::Player ? game.player_machines : game.opponent_machines)
+    {
+        if (!machine->is_alive())
+            continue;
+
+        auto machine_attacks = game.calculate_attacks(machine);
+        auto machine_moves = game.calculate_moves(machine);
+        attacks.insert(attacks.end(), machine_attacks.begin(), machine_attacks.end());
+        moves.insert(moves.end(), machine_moves.begin(), machine_moves.end());
+    }
+
+    // The same choice of actions the search has: a side with nothing left to do passes.
+    if (game.can_end_turn() || (attacks.empty() && moves.empty()))
+    {
+        auto index = layout.index_of(game, other_side(game.turn));
+        auto value = index.has_value() ? read_value(values, index.value()) : INVALID_VALUE;
+        if (value == UNRESOLVED_VALUE || value == INVALID_VALUE)
+        {
+            outcomes.has_unresolved = true;
+        }
+        else
+        {
+            // A win for the side that moves next is a loss for this one.
+            auto result = decode_value(value);
+            if (result.outcome == TablebaseOutcome::Loss)
+                outcomes.fastest_win = std::min(outcomes.fastest_win.value_or(result.turns + 1), result.turns + 1);
+            else
+                outcomes.slowest_loss = std::max(outcomes.slowest_loss, result.turns + 1);
+        }
+    }
+
+    auto visit = [&](Game &new_game)
+    {
+        auto winner = new_game.check_winner();
+        if (winner == Winner::None)
+            expand_turn(new_game, layout, values, outcomes);
+        else if ((winner == Winner::Player) == (game.turn == Player::Player))
+            outcomes.fastest_win = 1;
+        else
+            outcomes.slowest_loss = std::max(outcomes.slowest_loss, 1);
+    };
+
+    for (auto &attack : attacks)
+    {
+        Game new_game(game);
+        new_game.make_attack(attack);
+        visit(new_game);
+    }
+
+    for (auto &move : moves)
+    {
+        Game new_game(game);
+        new_game.make_move(move);
+        visit(new_game);
+    }
+}
+
+// Runs body(first, last) over the whole index range in chunks spread across the threads.
+template <typename Body>
+static void parallel_for(uint64_t count, uint32_t threads, Body body)
+{
+    std::atomic<uint64_t> next_chunk = 0;
+    auto chunks = (count + TABLEBASE_CHUNK_SIZE - 1) / TABLEBASE_CHUNK_SIZE;
+
+    auto worker = [&]()
+    {
+        for (auto chunk = next_chunk++; chunk < chunks; chunk = next_chunk++)
+            body(chunk * TABLEBASE_CHUNK_SIZE, std::min(count, (chunk + 1) * TABLEBASE_CHUNK_SIZE));
+    };
+
+    std::vector<std::thread> workers;
+    for (uint32_t i = 0; i < std::max(threads, 1u); ++i)
+        workers.emplace_back(worker);
+    for (auto &thread : workers)
+        thread.join();
+}
+
+TablebaseBuildSummary build_tablebase(const Game &game, const std::string &path, uint32_t threads)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<TablebaseMachine> machines;
+    for (const auto &side_machines : {game.player_machines, game.opponent_machines})
+    {
+        int32_t count = 0;
+        for (auto machine : side_machines)
+        {
+            if (!machine->is_alive())
+                continue;
+
+            machines.push_back({machine->id, machine->side, machine->health});
+            ++count;
+        }
+
+        if (count > MAX_TABLEBASE_MACHINES_PER_SIDE)
+            throw std::runtime_error("A tablebase holds at most " + std::to_string(MAX_TABLEBASE_MACHINES_PER_SIDE) + " machines per side");
+    }
+
+    if (machines.size() > MAX_TABLEBASE_MACHINES)
+        throw std::runtime_error("A tablebase holds at most " + std::to_string(MAX_TABLEBASE_MACHINES) + " machines");
+
+    // Interchangeable machines sit next to each other and share a health limit so that either may take the other's state.
+    std::stable_sort(machines.begin(), machines.end(), [](const TablebaseMachine &a, const TablebaseMachine &b)
+                     { return std::make_pair(a.side, a.id) < std::make_pair(b.side, b.id); });
+    for (size_t slot = 0; slot + 1 < machines.size(); ++slot)
+    {
+        if (same_kind(machines[slot], machines[slot + 1]))
+            machines[slot].max_health = machines[slot + 1].max_health = std::max(machines[slot].max_health, machines[slot + 1].max_health);
+    }
+
+    TablebaseLayout layout(game.board->terrain->spaces, machines, game.player_victory_points, game.opponent_victory_points);
+
+    MappedFile file(path, MappedFileMode::Create, TABLEBASE_HEADER_SIZE + layout.position_count * 2);
+    auto header = file.data();
+    std::memcpy(header, "MSTB", 4);
+    header[4] = TABLEBASE_VERSION;
+    header[5] = static_cast<uint8_t>(machines.size());
+    header[6] = static_cast<uint8_t>(game.player_victory_points);
+    header[7] = static_cast<uint8_t>(game.opponent_victory_points);
+    for (int32_t space = 0; space < 64; ++space)
+        header[8 + space] = static_cast<uint8_t>(static_cast<int32_t>(game.board->terrain->spaces.data[space / 8][space % 8]) - static_cast<int32_t>(Terrain::Chasm));
+    for (size_t slot = 0; slot < machines.size(); ++slot)
+    {
+        header[72 + slot * 3] = static_cast<uint8_t>(machines[slot].id);
+        header[73 + slot * 3] = static_cast<uint8_t>(machines[slot].side);
+        header[74 + slot * 3] = static_cast<uint8_t>(machines[slot].max_health);
+    }
+
+    auto values = file.data() + TABLEBASE_HEADER_SIZE;
+    TablebaseBuildSummary summary;
+    summary.positions = layout.position_count;
+
+    // Pass 0 marks unreachable indices and settles positions decided by the start-of-turn skills alone.
+    parallel_for(layout.position_count, threads, [&](uint64_t first, uint64_t last)
+                 {
+                     for (auto index = first; index < last; ++index)
+                     {
+                         auto position = layout.game_at(index);
+                         if (!position.has_value())
+                         {
+                             write_value(values, index, INVALID_VALUE);
+                             continue;
+                         }
+
+                         auto winner = position->check_winner();
+                         if (winner != Winner::None)
+                             write_value(values, index, encode_value((winner == Winner::Player) == (position->turn == Player::Player) ? TablebaseOutcome::Win : TablebaseOutcome::Loss, 0));
+                     } });
+
+    // If neither side can reach 7 victory points even with every other machine dead, every position is a draw.
+    int32_t player_points = 0;
+    int32_t opponent_points = 0;
+    for (const auto &machine : machines)
+        (machine.side == Player::Player ? player_points : opponent_points) += ALL_MACHINES[machine.id].get().points;
+    auto decisive = game.player_victory_points + opponent_points >= 7 || game.opponent_victory_points + player_points >= 7;
+
+    // Pass n settles every position decided in n turns: wins that reach a loss settled in an earlier pass, and losses whose
+    // every way out is a win settled in an earlier pass. Results are held back until the pass is over so that every
+    // thread sees the same table.
+    for (int32_t pass = 1; decisive; ++pass)
+    {
+        TRACE_ZONE("tablebase pass");
+
+        std::mutex updates_mutex;
+        std::vector<std::pair<uint64_t, uint16_t>> updates;
+        parallel_for(layout.position_count, threads, [&](uint64_t first, uint64_t last)
+                     {
+                         std::vector<std::pair<uint64_t, uint16_t>> chunk_updates;
+                         for (auto index = first; index < last; ++index)
+                         {
+                             if (read_value(values, index) != UNRESOLVED_VALUE)
+                                 continue;
+
+                             auto position = layout.game_at(index);
+                             TurnOutcomes outcomes;
+                             expand_turn(position.value(), layout, values, outcomes);
+
+                             if (outcomes.fastest_win.has_value())
+                                 chunk_updates.emplace_back(index, encode_value(TablebaseOutcome::Win, outcomes.fastest_win.value()));
+                             else if (!outcomes.has_unresolved)
+                                 chunk_updates.emplace_back(index, encode_value(TablebaseOutcome::Loss, outcomes.slowest_loss));
+                         }
+
+                         std::lock_guard lock(updates_mutex);
+                         updates.insert(updates.end(), chunk_updates.begin(), chunk_updates.end()); });
+
+        if (updates.empty())
+            break;
+
+        for (const auto &[index, value] : updates)
+            write_value(values, index, value);
+        summary.passes = pass;
+    }
+
+    for (uint64_t index = 0; index < layout.position_count; ++index)
+    {
+        auto value = read_value(values, index);
+        if (value == INVALID_VALUE)
+            continue;
+
+        auto result = decode_value(value);
+        if (value == UNRESOLVED_VALUE)
+            ++summary.draws;
+        else if (result.outcome == TablebaseOutcome::Win)
+            ++summary.wins;
+        else
+            ++summary.losses;
+    }
+
+    file.flush();
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return summary;
+}
+
+Tablebase::Tablebase(const std::string &path) : file(path, MappedFileMode::ReadOnly)
+{
+    auto header = file.data();
+    if (file.size() < TABLEBASE_HEADER_SIZE || std::memcmp(header, "MSTB", 4) != 0)
+        throw std::runtime_error(path + " is not a tablebase");
+    if (header[4] != TABLEBASE_VERSION)
+        throw std::runtime_error("Unsupported tablebase version " + std::to_string(header[4]));
+    if (header[5] > MAX_TABLEBASE_MACHINES)
+        throw std::runtime_error("Invalid tablebase machine count");
+
+    BoardType<Terrain> terrain;
+    for (int32_t space = 0; space < 64; ++space)
+    {
+        if (header[8 + space] > static_cast<int32_t>(Terrain::Mountain) - static_cast<int32_t>(Terrain::Chasm))
+            throw std::runtime_error("Invalid tablebase terrain");
+        terrain.data[space / 8][space % 8] = static_cast<Terrain>(header[8 + space] + static_cast<int32_t>(Terrain::Chasm));
+    }
+
+    std::vector<TablebaseMachine> machines;
+    for (int32_t slot = 0; slot < header[5]; ++slot)
+    {
+        TablebaseMachine machine{header[72 + slot * 3], static_cast<Player>(header[73 + slot * 3] & 1), header[74 + slot * 3]};
+        if (machine.id >= static_cast<int32_t>(ALL_MACHINES.size()) || machine.max_health == 0)
+            throw std::runtime_error("Invalid tablebase machine");
+        machines.push_back(machine);
+    }
+
+    layout = TablebaseLayout(terrain, machines, header[6], header[7]);
+    if (file.size() != TABLEBASE_HEADER_SIZE + layout.position_count * 2)
+        throw std::runtime_error(path + " is truncated");
+}
+
+std::optional<TablebaseResult> Tablebase::probe(const Game &game, Player to_move) const
+{
+    auto index = layout.index_of(game, to_move);
+    if (!index.has_value() && std::all_of(layout.machines.begin(), layout.machines.end(), [](const TablebaseMachine &machine)
+                                          { return MACHINE_TABLE.mirror_symmetric[machine.id]; }))
+        index = layout.index_of(game, to_move, true);
+    if (!index.has_value())
+        return std::nullopt;
+
+    auto value = read_value(file.data() + TABLEBASE_HEADER_SIZE, index.value());
+    if (value == INVALID_VALUE)
+        return std::nullopt;
+
+    return decode_value(value);
+}
+
+std::string Tablebase::description() const
+{
+    std::ostringstream str;
+    for (size_t slot = 0; slot < layout.machines.size(); ++slot)
+    {
+        const auto &machine = layout.machines[slot];
+        if (slot > 0)
+            str << " ";
+        str << ALL_MACHINES[machine.id].get().name << "(" << (machine.side == Player::Player ? "player" : "opponent") << "," << machine.max_health << ")";
+    }
+
+    return str.str();
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "enums.h"
+#include "game.h"
+#include "mapped_file.h"
+
+// The most machines a tablebase can be built for, per side and in total (2 vs 1 or 2 vs 2).
+constexpr int32_t MAX_TABLEBASE_MACHINES_PER_SIDE = 2;
+constexpr int32_t MAX_TABLEBASE_MACHINES = 4;
+
+enum class TablebaseOutcome
+{
+    Draw,
+    Win,
+    Loss,
+};
+
+class TablebaseResult
+{
+public:
+    // From the perspective of the side about to start its turn. Draw covers every position that neither side can force
+    // to 7 victory points.
+    TablebaseOutcome outcome = TablebaseOutcome::Draw;
+    // Turns, counting the side to move's own, until the game is decided. Zero if it is decided by the start of the turn itself.
+    int32_t turns = 0;
+};
+
+// One machine of the set a tablebase was built for.
+class TablebaseMachine
+{
+public:
+    int32_t id;
+    Player side;
+    int32_t max_health;
+};
+
+// How the positions of a tablebase are numbered. Each machine has a state: 0 if it is dead, otherwise 1 + its space,
+// facing and health packed together. The index is the side to move plus the machine states in mixed radix.
+// Machines that share a definition and a side are interchangeable, so their states are kept in ascending order.
+// Only spaces a machine can move onto are numbered: a machine that is knocked into a chasm it cannot fly over leaves
+// the tablebase.
+class TablebaseLayout
+{
+public:
+    BoardType<Terrain> terrain;
+    std::vector<TablebaseMachine> machines;
+    // Victory points each side has while all of the machines are alive.
+    int32_t player_base_victory_points = 0;
+    int32_t opponent_base_victory_points = 0;
+    // Per machine, the spaces it can stand on, and each board space's position in that list or -1.
+    std::vector<std::vector<int32_t>> spaces;
+    std::vector<std::array<int32_t, 64>> space_indices;
+    std::vector<uint64_t> strides;
+    uint64_t position_count = 2;
+
+    TablebaseLayout() = default;
+    TablebaseLayout(const BoardType<Terrain> &terrain, const std::vector<TablebaseMachine> &machines, int32_t player_base_victory_points, int32_t opponent_base_victory_points);
+
+    // Empty if the game has machines this layout does not, or victory points that do not add up.
+    // If mirror is set, the game is looked up reflected across the board's vertical axis.
+    std::optional<uint64_t> index_of(const Game &game, Player to_move, bool mirror = false) const;
+    // The position at the given index, at the start of the side to move's turn after its start-of-turn skills have fired.
+    // Empty for indices that do not describe a reachable position.
+    std::optional<Game> game_at(uint64_t index) const;
+
+private:
+    uint64_t state_count(size_t slot) const;
+};
+
+// A solved set of endgame positions, memory-mapped from disk.
+//
+// A tablebase is built for one terrain layout, one set of machines and the victory points each side had before any of
+// those machines died. Positions are taken between turns, before the start-of-turn skills of the side to move fire:
+// each machine is either dead or on some space with some facing and up to the health it was built with.
+// Terrain never changes during a game in this engine, and victory points follow from which machines are dead, so
+// that is the whole position.
+//
+// On disk a tablebase is:
+//   4 bytes  "MSTB"
+//   1 byte   format version
+//   1 byte   machine count
+//   2 bytes  player and opponent base victory points
+//   64 bytes terrain, row by row
+//   3 bytes  per machine: definition id, side, max health
+//   padding to 96 bytes
+//   2 bytes  per position, little-endian
+class Tablebase
+{
+    MappedFile file;
+    TablebaseLayout layout;
+
+public:
+    explicit Tablebase(const std::string &path);
+
+    // The result for the given side starting its turn from the game's position, before that side's start-of-turn skills.
+    // Empty if neither the position nor, when every machine in it plays the same mirrored, its mirror is covered.
+    std::optional<TablebaseResult> probe(const Game &game, Player to_move) const;
+
+    // The machines this tablebase was built for, e.g. "Scrapper(player,3) Burrower(opponent,2)".
+    std::string description() const;
+    uint64_t position_count() const { return layout.position_count; }
+};
+
+class TablebaseBuildSummary
+{
+public:
+    uint64_t positions = 0;
+    uint64_t wins = 0;
+    uint64_t losses = 0;
+    uint64_t draws = 0;
+    int32_t passes = 0;
+    double seconds = 0;
+};
+
+// Solves every position reachable by the alive machines of the game, on its terrain and with up to their current health,
+// and writes the tablebase to path. Throws if there are more machines than a tablebase can hold.
+TablebaseBuildSummary build_tablebase(const Game &game, const std::string &path, uint32_t threads);
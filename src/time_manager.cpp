@@ -0,0 +1,69 @@
+#include <algorithm>
+#include "time_manager.h"
+
+// Kept back from the clock for everything besides searching.
+constexpr double CLOCK_SAFETY_SECONDS = 0.05;
+// Actions a player is expected to still have to make, however far into the game they are.
+constexpr int32_t EXPECTED_GAME_ACTIONS = 100;
+constexpr int32_t MIN_ACTIONS_TO_GO = 20;
+// The share of each increment that is spent on the action it comes with.
+constexpr double INCREMENT_SHARE = 0.75;
+// The hard limit is this many soft limits, but never more than half of what is left.
+constexpr double HARD_LIMIT_FACTOR = 4;
+constexpr double MAX_SCALE = 3;
+constexpr double MIN_SCALE = 0.5;
+// Iterations with the same best action before it counts as settled.
+constexpr int32_t STABLE_ITERATIONS = 3;
+// An iteration takes longer than all those before it, so one is only started while most of the budget is left.
+constexpr double NEXT_ITERATION_SHARE = 0.6;
+// Iterations with the same best action and no fall in score before it counts as dominating, and the share of the soft
+// limit spent before a dominating action is played.
+constexpr int32_t DOMINANT_ITERATIONS = 5;
+constexpr double DOMINANT_SHARE = 0.15;
+
+TimeManager::TimeManager(const GameClock &clock)
+{
+    auto available = std::max(clock.remaining_seconds - CLOCK_SAFETY_SECONDS, 0.0);
+    auto actions_to_go = std::max(MIN_ACTIONS_TO_GO, EXPECTED_GAME_ACTIONS - clock.actions_played);
+
+    soft_limit = std::min(available / actions_to_go + clock.increment_seconds * INCREMENT_SHARE, available);
+    hard_limit = std::min(soft_limit * HARD_LIMIT_FACTOR, std::max(soft_limit, available / 2));
+}
+
+bool TimeManager::next_iteration(const Action &best_action, int32_t score, size_t root_actions, double elapsed_seconds)
+{
+    // There is nothing to choose between.
+    if (root_actions <= 1)
+        return false;
+
+    if (last_best_action.has_value())
+    {
+        if (!(best_action == last_best_action.value()))
+        {
+            scale = std::min(scale * 1.5, MAX_SCALE);
+            stable_iterations = 0;
+            dominant_iterations = 0;
+        }
+        else if (++stable_iterations >= STABLE_ITERATIONS)
+        {
+            scale = std::max(scale * 0.8, MIN_SCALE);
+        }
+
+        // Losing a victory point is worth looking at more closely.
+        if (score < last_score)
+        {
+            scale = std::min(scale * 1.25, MAX_SCALE);
+            dominant_iterations = 0;
+        }
+        else if (best_action == last_best_action.value())
+        {
+            ++dominant_iterations;
+        }
+    }
+
+    last_best_action = best_action;
+    last_score = score;
+    if (dominant_iterations >= DOMINANT_ITERATIONS && elapsed_seconds >= soft_limit * DOMINANT_SHARE)
+        return false;
+    return elapsed_seconds < std::min(soft_limit * scale, hard_limit) * NEXT_ITERATION_SHARE;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include "action.h"
+
+// A player's clock: the time they have left for the rest of the game, the time added after each of their actions, and
+// how many actions they have played so far.
+class GameClock
+{
+public:
+    double remaining_seconds = 0;
+    double increment_seconds = 0;
+    int32_t actions_played = 0;
+};
+
+// Decides how long one search may take from the game clock. The search stops at the hard limit no matter what, and
+// between iterations the time manager decides whether another one is worth starting: it allows more time while the best
+// action keeps changing or the score is falling, and less once the best action has settled. A best action that has
+// held for long enough without its score falling dominates the rest, and the search stops early with it.
+class TimeManager
+{
+    double soft_limit;
+    double hard_limit;
+    // How much of the soft limit to use, adjusted after each iteration.
+    double scale = 1;
+    std::optional<Action> last_best_action;
+    int32_t last_score = 0;
+    int32_t stable_iterations = 0;
+    // Iterations in a row with the same best action and a score that did not fall.
+    int32_t dominant_iterations = 0;
+
+public:
+    TimeManager(const GameClock &clock);
+
+    double soft_seconds() const { return soft_limit; }
+    // Never more than the clock has left, less a margin for the time it takes to answer.
+    double hard_seconds() const { return hard_limit; }
+
+    // Called after each completed iteration, with the number of legal actions at the root. Returns whether to start
+    // another iteration.
+    bool next_iteration(const Action &best_action, int32_t score, size_t root_actions, double elapsed_seconds);
+};
@@ -0,0 +1,117 @@
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "trace.h"
+
+#ifdef MACHINE_STRIKE_TRACING
+
+class TraceEvent
+{
+public:
+    const char *name;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point end;
+};
+
+// Every thread appends to its own buffer. The registry keeps the buffers alive after their threads exit
+// so that zones from short lived worker threads still make it into the trace.
+class TraceBuffer
+{
+public:
+    uint32_t thread_id;
+    std::vector<TraceEvent> events;
+};
+
+static std::atomic<bool> tracing = false;
+static std::mutex registry_mutex;
+static std::vector<std::shared_ptr<TraceBuffer>> registry;
+static std::chrono::steady_clock::time_point trace_start_time;
+
+static TraceBuffer &thread_buffer()
+{
+    thread_local std::shared_ptr<TraceBuffer> buffer;
+    if (buffer == nullptr)
+    {
+        std::lock_guard lock(registry_mutex);
+        buffer = std::make_shared<TraceBuffer>();
+        buffer->thread_id = static_cast<uint32_t>(registry.size());
+        buffer->events.reserve(1 << 16);
+        registry.push_back(buffer);
+    }
+
+    return *buffer;
+}
+
+TraceZone::TraceZone(const char *name) : name(name), recording(tracing.load(std::memory_order_relaxed))
+{
+    if (recording)
+        start = std::chrono::steady_clock::now();
+}
+
+TraceZone::~TraceZone()
+{
+    if (recording)
+        thread_buffer().events.push_back({name, start, std::chrono::steady_clock::now()});
+}
+
+bool start_trace()
+{
+    std::lock_guard lock(registry_mutex);
+    for (auto &buffer : registry)
+        buffer->events.clear();
+
+    trace_start_time = std::chrono::steady_clock::now();
+    tracing = true;
+    return true;
+}
+
+void stop_trace(const std::string &path)
+{
+    tracing = false;
+
+    std::ofstream file(path);
+    if (!file)
+        throw std::runtime_error("Could not write " + path);
+
+    // The buffers themselves are not locked while zones record, so this must only be called once the traced work has finished.
+    std::lock_guard lock(registry_mutex);
+    file << std::fixed << std::setprecision(3);
+    file << "{\"traceEvents\":[\n";
+
+    bool first = true;
+    for (auto &buffer : registry)
+    {
+        file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->thread_id
+             << ",\"args\":{\"name\":\"Thread " << buffer->thread_id << "\"}}";
+        first = false;
+
+        for (const auto &event : buffer->events)
+        {
+            auto start = std::chrono::duration<double, std::micro>(event.start - trace_start_time).count();
+            auto duration = std::chrono::duration<double, std::micro>(event.end - event.start).count();
+            file << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->thread_id
+                 << ",\"ts\":" << start << ",\"dur\":" << duration << "}";
+        }
+
+        buffer->events.clear();
+    }
+
+    file << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+#else
+
+bool start_trace()
+{
+    return false;
+}
+
+void stop_trace([[maybe_unused]] const std::string &path)
+{
+}
+
+#endif
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+// Scoped timing zones for the hot paths, written out as Chrome trace events (chrome://tracing, Perfetto).
+// Zones are only compiled in when the build defines MACHINE_STRIKE_TRACING (the MACHINE_STRIKE_TRACING
+// CMake option), and only record while a trace is running.
+
+// Starts recording zones on every thread. Returns false if tracing is not compiled in.
+bool start_trace();
+// Stops recording and writes everything recorded since start_trace to a trace-event JSON file.
+void stop_trace(const std::string &path);
+
+#ifdef MACHINE_STRIKE_TRACING
+
+class TraceZone
+{
+    const char *name;
+    std::chrono::steady_clock::time_point start;
+    bool recording;
+
+public:
+    TraceZone(const char *name);
+    ~TraceZone();
+};
+
+#define TRACE_ZONE_NAME(line) trace_zone_##line
+#define TRACE_ZONE_LINE(name, line) TraceZone TRACE_ZONE_NAME(line)(name)
+#define TRACE_ZONE(name) TRACE_ZONE_LINE(name, __LINE__)
+
+#else
+
+#define TRACE_ZONE(name)
+
+#endif
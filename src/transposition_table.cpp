@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "transposition_table.h"
+#include "zobrist.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+constexpr uint32_t TRANSPOSITION_FILE_VERSION = 2;
+constexpr size_t TRANSPOSITION_FILE_HEADER_SIZE = 64;
+
+// Packed entry fields, from the least significant bit up.
+constexpr int32_t ACTION_SHIFT = 0;
+constexpr int32_t SCORE_SHIFT = 16;
+constexpr int32_t DEPTH_SHIFT = 32;
+constexpr int32_t BOUND_SHIFT = 40;
+constexpr int32_t HAS_ACTION_SHIFT = 42;
+constexpr int32_t OCCUPIED_SHIFT = 43;
+constexpr int32_t AGE_SHIFT = 44;
+
+// How many plies of depth an entry is worth less for each search since it was stored, when picking one to replace.
+constexpr int32_t AGE_DEPTH_PENALTY = 8;
+
+static uint64_t pack_entry(const TranspositionEntry &entry)
+{
+    return static_cast<uint64_t>(entry.action) << ACTION_SHIFT |
+           static_cast<uint64_t>(static_cast<uint16_t>(entry.score)) << SCORE_SHIFT |
+           static_cast<uint64_t>(static_cast<uint8_t>(entry.depth)) << DEPTH_SHIFT |
+           static_cast<uint64_t>(entry.bound) << BOUND_SHIFT |
+           static_cast<uint64_t>(entry.has_action) << HAS_ACTION_SHIFT |
+           static_cast<uint64_t>(entry.occupied) << OCCUPIED_SHIFT |
+           static_cast<uint64_t>(entry.age) << AGE_SHIFT;
+}
+
+static TranspositionEntry unpack_entry(uint64_t key, uint64_t data)
+{
+    TranspositionEntry entry;
+    entry.key = key;
+    entry.action = static_cast<uint16_t>(data >> ACTION_SHIFT);
+    entry.score = static_cast<int16_t>(static_cast<uint16_t>(data >> SCORE_SHIFT));
+    entry.depth = static_cast<int8_t>(static_cast<uint8_t>(data >> DEPTH_SHIFT));
+    entry.bound = static_cast<ScoreBound>((data >> BOUND_SHIFT) & 3);
+    entry.has_action = (data >> HAS_ACTION_SHIFT) & 1;
+    entry.occupied = (data >> OCCUPIED_SHIFT) & 1;
+    entry.age = static_cast<uint8_t>(data >> AGE_SHIFT);
+    return entry;
+}
+
+// Slots are read and written one word at a time without locks. The check word is what catches a slot that
+// another thread or process was halfway through writing.
+static std::optional<TranspositionEntry> load_entry(PackedTranspositionEntry &slot, uint64_t key)
+{
+    auto check = std::atomic_ref<uint64_t>(slot.check).load(std::memory_order_relaxed);
+    auto data = std::atomic_ref<uint64_t>(slot.data).load(std::memory_order_relaxed);
+    if ((check ^ data) != key)
+        return std::nullopt;
+
+    auto entry = unpack_entry(key, data);
+    if (!entry.occupied || entry.bound > ScoreBound::Upper)
+        return std::nullopt;
+
+    return entry;
+}
+
+static void save_entry(PackedTranspositionEntry &slot, const TranspositionEntry &entry)
+{
+    auto data = pack_entry(entry);
+    std::atomic_ref<uint64_t>(slot.check).store(entry.key ^ data, std::memory_order_relaxed);
+    std::atomic_ref<uint64_t>(slot.data).store(data, std::memory_order_relaxed);
+}
+
+// How much a slot holding some other position is worth keeping. Empty slots are worth nothing.
+static int32_t replacement_worth(PackedTranspositionEntry &slot, uint8_t generation)
+{
+    auto entry = unpack_entry(0, std::atomic_ref<uint64_t>(slot.data).load(std::memory_order_relaxed));
+    if (!entry.occupied)
+        return INT32_MIN;
+
+    auto searches_ago = static_cast<uint8_t>(generation - entry.age);
+    return entry.depth - AGE_DEPTH_PENALTY * searches_ago;
+}
+
+// Buckets are aligned to a cache line, and large tables to a huge page so that the system can back them with huge pages.
+static TranspositionBucket *allocate_transposition_buckets(uint64_t count)
+{
+    auto size = count * sizeof(TranspositionBucket);
+#ifdef _WIN32
+    auto buckets = static_cast<TranspositionBucket *>(_aligned_malloc(size, alignof(TranspositionBucket)));
+#else
+    constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    auto alignment = size >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : alignof(TranspositionBucket);
+    auto buckets = static_cast<TranspositionBucket *>(std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment));
+#ifdef MADV_HUGEPAGE
+    if (buckets != nullptr && alignment == HUGE_PAGE_SIZE)
+        madvise(buckets, size, MADV_HUGEPAGE);
+#endif
+#endif
+    if (buckets == nullptr)
+        throw std::bad_alloc();
+
+    std::memset(static_cast<void *>(buckets), 0, size);
+    return buckets;
+}
+
+void TranspositionBucketDeleter::operator()(TranspositionBucket *buckets) const
+{
+#ifdef _WIN32
+    _aligned_free(buckets);
+#else
+    std::free(buckets);
+#endif
+}
+
+static uint64_t zobrist_fingerprint()
+{
+    return ZOBRIST.opponent_to_move ^ ZOBRIST.terrain[0][0] ^ ZOBRIST.machine_id[63][63];
+}
+
+static uint64_t header_checksum(uint32_t version, uint64_t count, uint64_t fingerprint)
+{
+    auto z = (static_cast<uint64_t>(version) * 0x9E3779B97F4A7C15) ^ count ^ std::rotl(fingerprint, 17);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    return z ^ (z >> 31);
+}
+
+TranspositionTable::TranspositionTable(size_t megabytes, const std::string &path)
+{
+    // Round down to a power of two so that a bucket is a mask away from the key.
+    count = std::bit_floor(std::max<size_t>(megabytes * 1024 * 1024 / sizeof(TranspositionBucket), 1));
+    mask = count - 1;
+
+    if (path.empty() || !open_file(path))
+    {
+        owned_buckets.reset(allocate_transposition_buckets(count));
+        buckets = owned_buckets.get();
+    }
+}
+
+bool TranspositionTable::open_file(const std::string &path)
+{
+    auto size = TRANSPOSITION_FILE_HEADER_SIZE + count * sizeof(TranspositionBucket);
+    auto fingerprint = zobrist_fingerprint();
+
+    try
+    {
+        try
+        {
+            file.emplace(path, MappedFileMode::ReadWrite);
+        }
+        catch (const std::runtime_error &)
+        {
+            file.emplace(path, MappedFileMode::Create, size);
+        }
+
+        auto header = file->data();
+        uint32_t version = 0;
+        uint64_t file_count = 0;
+        uint64_t file_fingerprint = 0;
+        uint64_t checksum = 0;
+        if (file->size() == size)
+        {
+            std::memcpy(&version, header + 4, 4);
+            std::memcpy(&file_count, header + 8, 8);
+            std::memcpy(&file_fingerprint, header + 16, 8);
+            std::memcpy(&checksum, header + 24, 8);
+        }
+
+        auto valid = file->size() == size &&
+                     std::memcmp(header, "MSTT", 4) == 0 &&
+                     version == TRANSPOSITION_FILE_VERSION &&
+                     file_count == count &&
+                     file_fingerprint == fingerprint &&
+                     checksum == header_checksum(version, file_count, file_fingerprint);
+
+        if (!valid)
+        {
+            file.reset();
+            file.emplace(path, MappedFileMode::Create, size);
+            header = file->data();
+
+            auto new_checksum = header_checksum(TRANSPOSITION_FILE_VERSION, count, fingerprint);
+            std::memcpy(header, "MSTT", 4);
+            std::memcpy(header + 4, &TRANSPOSITION_FILE_VERSION, 4);
+            std::memcpy(header + 8, &count, 8);
+            std::memcpy(header + 16, &fingerprint, 8);
+            std::memcpy(header + 24, &new_checksum, 8);
+        }
+    }
+    catch (const std::runtime_error &)
+    {
+        file.reset();
+        return false;
+    }
+
+    // The mapping starts on a page, so after the header the buckets are still aligned to cache lines.
+    buckets = reinterpret_cast<TranspositionBucket *>(file->data() + TRANSPOSITION_FILE_HEADER_SIZE);
+    file_path = path;
+    return true;
+}
+
+std::optional<TranspositionEntry> TranspositionTable::probe(uint64_t key) const
+{
+    for (auto &slot : buckets[key & mask].entries)
+    {
+        auto entry = load_entry(slot, key);
+        if (entry.has_value())
+            return entry;
+    }
+
+    return std::nullopt;
+}
+
+void TranspositionTable::store(uint64_t key, int32_t depth, int32_t score, ScoreBound bound, std::optional<Action> best_action)
+{
+    auto current_generation = generation.load(std::memory_order_relaxed);
+
+    // The position's own slot if it has one, otherwise the one least worth keeping.
+    PackedTranspositionEntry *slot = nullptr;
+    std::optional<TranspositionEntry> old_entry;
+    auto slot_worth = INT32_MAX;
+    for (auto &candidate : buckets[key & mask].entries)
+    {
+        old_entry = load_entry(candidate, key);
+        if (old_entry.has_value())
+        {
+            slot = &candidate;
+            break;
+        }
+
+        auto worth = replacement_worth(candidate, current_generation);
+        if (worth < slot_worth)
+        {
+            slot = &candidate;
+            slot_worth = worth;
+        }
+    }
+
+    if (old_entry.has_value() && old_entry->age == current_generation && old_entry->depth > depth)
+        return;
+
+    TranspositionEntry entry;
+    entry.key = key;
+    entry.depth = static_cast<int8_t>(std::clamp(depth, 0, 127));
+    entry.score = static_cast<int16_t>(score);
+    entry.bound = bound;
+    entry.occupied = true;
+    entry.age = current_generation;
+
+    // Keep the old best action if this search did not produce one.
+    if (best_action.has_value())
+    {
+        entry.has_action = true;
+        entry.action = best_action->encode();
+    }
+    else if (old_entry.has_value())
+    {
+        entry.has_action = old_entry->has_action;
+        entry.action = old_entry->action;
+    }
+
+    save_entry(*slot, entry);
+}
+
+void TranspositionTable::new_search()
+{
+    generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear()
+{
+    std::memset(static_cast<void *>(buckets), 0, count * sizeof(TranspositionBucket));
+}
+
+size_t TranspositionTable::megabytes() const
+{
+    return count * sizeof(TranspositionBucket) / (1024 * 1024);
+}
+
+void TranspositionTable::flush()
+{
+    if (file.has_value())
+        file->flush();
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include "action.h"
+#include "enums.h"
+#include "mapped_file.h"
+
+class TranspositionEntry
+{
+public:
+    uint64_t key = 0;
+    uint16_t action = 0;
+    int16_t score = 0;
+    int8_t depth = 0;
+    ScoreBound bound = ScoreBound::Exact;
+    bool has_action = false;
+    bool occupied = false;
+    // The table's generation when the entry was stored, see TranspositionTable::new_search.
+    uint8_t age = 0;
+
+    std::optional<Action> best_action() const
+    {
+        return has_action ? std::optional<Action>(Action::decode(action)) : std::nullopt;
+    }
+};
+
+// How an entry is kept in the table: the entry's fields packed into one word, and that word XORed with the key.
+// A slot is only trusted if the two words XOR back to the probed key, so an entry torn by a concurrent write,
+// or garbage read from a damaged file, is treated as empty instead of being returned for the wrong position.
+class PackedTranspositionEntry
+{
+public:
+    uint64_t check;
+    uint64_t data;
+};
+
+constexpr size_t TRANSPOSITION_BUCKET_ENTRIES = 4;
+
+// The slots a key can go in, filling exactly one cache line.
+class alignas(64) TranspositionBucket
+{
+public:
+    std::array<PackedTranspositionEntry, TRANSPOSITION_BUCKET_ENTRIES> entries;
+};
+
+static_assert(sizeof(TranspositionBucket) == 64);
+
+// Frees memory from allocate_transposition_buckets.
+class TranspositionBucketDeleter
+{
+public:
+    void operator()(TranspositionBucket *buckets) const;
+};
+
+// A hash table of search results keyed by Game::hash. Each key maps to a bucket of four slots. A new result replaces
+// the one for the same position unless that one was searched deeper during the current search, and otherwise goes in
+// the slot whose entry is the shallowest once older searches' entries are marked down by how many searches ago they were.
+// Slots are read and written without locks, so any number of search threads can share a table.
+//
+// The table can be backed by a file so that it survives restarts and can be shared by several engine processes
+// on the same host. The file is a 64 byte header followed by the slots, in host byte order:
+//   4 bytes  "MSTT"
+//   4 bytes  format version
+//   8 bytes  bucket count
+//   8 bytes  fingerprint of the Zobrist keys the hashes were made with
+//   8 bytes  checksum of the fields above
+// A file with a bad header, or one made for another size, is wiped and started over.
+class TranspositionTable
+{
+    std::unique_ptr<TranspositionBucket[], TranspositionBucketDeleter> owned_buckets;
+    std::optional<MappedFile> file;
+    TranspositionBucket *buckets;
+    uint64_t count;
+    uint64_t mask;
+    std::string file_path;
+    std::atomic<uint8_t> generation = 0;
+
+    bool open_file(const std::string &path);
+
+public:
+    // If path is not empty the table is backed by that file. If the file cannot be opened or mapped,
+    // the table falls back to memory, on huge pages where the system offers them.
+    TranspositionTable(size_t megabytes, const std::string &path = "");
+
+    std::optional<TranspositionEntry> probe(uint64_t key) const;
+    void store(uint64_t key, int32_t depth, int32_t score, ScoreBound bound, std::optional<Action> best_action);
+    // Ages every entry by one search, so that entries from earlier searches are the first to be replaced.
+    void new_search();
+    void clear();
+    size_t megabytes() const;
+
+    // The backing file, or empty if the table lives in memory.
+    const std::string &path() const { return file_path; }
+    // Writes a file backed table out to disk.
+    void flush();
+};
@@ -22,6 +22,35 @@ inline MachineDirection opposite_direction(MachineDirection direction)
     throw std::invalid_argument("Invalid direction");
 }
 
+// The direction after reflecting the board across its vertical axis.
+inline MachineDirection mirror_direction(MachineDirection direction)
+{
+    switch (direction)
+    {
+    case MachineDirection::West:
+        return MachineDirection::East;
+    case MachineDirection::East:
+        return MachineDirection::West;
+    default:
+        return direction;
+    }
+}
+
+// The sides after reflecting a machine across its own front to rear axis.
+constexpr MachineSide mirror_sides(MachineSide sides)
+{
+    auto value = static_cast<int>(sides);
+    auto left = value & static_cast<int>(MachineSide::Left);
+    auto right = value & static_cast<int>(MachineSide::Right);
+    value &= ~(static_cast<int>(MachineSide::Left) | static_cast<int>(MachineSide::Right));
+    return static_cast<MachineSide>(value | (left ? static_cast<int>(MachineSide::Right) : 0) | (right ? static_cast<int>(MachineSide::Left) : 0));
+}
+
+inline Coord mirror_coord(Coord coord)
+{
+    return {coord.row, 7 - coord.column};
+}
+
 inline Coord traverse_direction(Coord source, MachineDirection direction, int32_t distance = 1)
 {
     switch (direction)
@@ -92,7 +121,7 @@ inline MachineDirection get_direction(Coord source, Coord destination)
     }
 }
 
-inline MachineSide side_tangent_to_direction(MachineDirection source_direction, MachineDirection target_direction)
+constexpr MachineSide side_tangent_to_direction(MachineDirection source_direction, MachineDirection target_direction)
 {
     switch (source_direction)
     {
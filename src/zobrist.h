@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Random keys for Zobrist hashing. Every machine attribute gets its own key per space so that
+// a position's hash is the XOR of the keys of everything on the board.
+class ZobristKeys
+{
+public:
+    std::array<std::array<uint64_t, 6>, 64> terrain;
+    std::array<std::array<uint64_t, 64>, 64> machine_id;
+    std::array<std::array<uint64_t, 4>, 64> direction;
+    std::array<std::array<uint64_t, 2>, 64> side;
+    std::array<std::array<uint64_t, 16>, 64> health;
+    std::array<std::array<uint64_t, 8>, 64> machine_state;
+    std::array<std::array<uint64_t, 16>, 64> attack_power_modifier;
+    std::array<uint64_t, 64> last_touched;
+    std::array<uint64_t, 3> game_state;
+    std::array<uint64_t, 64> player_victory_points;
+    std::array<uint64_t, 64> opponent_victory_points;
+    uint64_t opponent_to_move;
+    uint64_t must_move_last_touched_machine;
+
+    ZobristKeys()
+    {
+        // splitmix64 with a fixed seed, so hashes are stable across runs and can be stored on disk.
+        uint64_t state = 0x4D535A6F62726973;
+        auto next = [&state]()
+        {
+            uint64_t z = (state += 0x9E3779B97F4A7C15);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+            return z ^ (z >> 31);
+        };
+
+        auto fill = [&next](auto &table)
+        {
+            for (auto &row : table)
+            {
+                for (auto &key : row)
+                    key = next();
+            }
+        };
+
+        fill(terrain);
+        fill(machine_id);
+        fill(direction);
+        fill(side);
+        fill(health);
+        fill(machine_state);
+        fill(attack_power_modifier);
+
+        for (auto &key : last_touched)
+            key = next();
+        for (auto &key : game_state)
+            key = next();
+        for (auto &key : player_victory_points)
+            key = next();
+        for (auto &key : opponent_victory_points)
+            key = next();
+
+        opponent_to_move = next();
+        must_move_last_touched_machine = next();
+    }
+};
+
+inline const ZobristKeys ZOBRIST;
@@ -8,6 +8,18 @@
 #include "../src/machine_definitions.h"
 #include "../src/attack.h"
 #include "../src/machine.h"
+#include "../src/position.h"
+#include "../src/game_record.h"
+#include "../src/tablebase.h"
+#include "../src/opening_book.h"
+#include "../src/object_pool.h"
+#include "../src/machine_table.h"
+#include "../src/selfplay.h"
+#include "../src/reachability.h"
+#include "../src/time_manager.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
 
 auto all_grassland = BoardType{Terrain::Grassland};
 
@@ -57,7 +69,7 @@ TEST(machine_strike_engine_test, Melee_knockback_into_wall_damages_attacker_once
   auto friendly_burrower = game.board->machine_at({6, 0});
   auto enemy_burrower = game.board->machine_at({7, 0});
 
-  game.board->terrain_at({7, 0}) = Terrain::Hill; // Give the enemy a hill so that the combat power matches the attacker
+  game.board->set_terrain({7, 0}, Terrain::Hill); // Give the enemy a hill so that the combat power matches the attacker
 
   MAKE_FIRST_ATTACK(game, friendly_burrower);
 
@@ -73,7 +85,7 @@ TEST(machine_strike_engine_test, Melee_knockback_damages_both_once_moves_defende
                            GameMachine(std::ref(BURROWER), MachineDirection::North, {6, 0}, MachineState::Ready, Player::Opponent)});
   auto friendly_burrower = game.board->machine_at({5, 0});
   auto enemy_burrower = game.board->machine_at({6, 0});
-  game.board->terrain_at({6, 0}) = Terrain::Hill; // Give the enemy a hill so that the combat power matches the attacker
+  game.board->set_terrain({6, 0}, Terrain::Hill); // Give the enemy a hill so that the combat power matches the attacker
 
   MAKE_FIRST_ATTACK(game, friendly_burrower);
 
@@ -285,4 +297,932 @@ TEST(machine_strike_engine_test, Ram_attack_blocked_by_machine_causes_damage_to_
   EXPECT_EQ(enemy1->health, GRAZER.health - 2);      // One point of health for the attack and one for getting rammed into another machine
   EXPECT_EQ(enemy2->health, GRAZER.health - 1);      // One point of health for getting rammed into by the defender
   EXPECT_TRUE(friendly->coordinates == Coord(2, 3)); // We couldn't move
-}
\ No newline at end of file
+}
+
+TEST(machine_strike_engine_test, Packed_position_round_trips_mid_turn_state)
+{
+  auto game = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(GRAZER), MachineDirection::North, {2, 3}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(SNAPMAW), MachineDirection::East, {6, 1}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(BURROWER), MachineDirection::West, {1, 3}, MachineState::Ready, Player::Opponent)});
+  game.board->set_terrain({4, 4}, Terrain::Chasm);
+  game.board->set_terrain({7, 7}, Terrain::Mountain);
+  game.opponent_victory_points = 3;
+
+  MAKE_FIRST_ATTACK(game, game.board->machine_at({2, 3}));
+
+  auto packed = pack_position(game);
+  EXPECT_EQ(packed.size, encoded_position_size(game));
+  EXPECT_LE(packed.size, 60);
+
+  auto decoded = unpack_position(packed);
+  EXPECT_EQ(decoded.turn, game.turn);
+  EXPECT_EQ(decoded.state, game.state);
+  EXPECT_EQ(decoded.opponent_victory_points, 3);
+  EXPECT_TRUE(decoded.must_move_last_touched_machine);
+  EXPECT_EQ(decoded.last_touched_machine, decoded.board->machine_at(game.last_touched_machine->coordinates));
+  EXPECT_EQ(decoded.board->terrain_at({4, 4}), Terrain::Chasm);
+  EXPECT_EQ(decoded.board->terrain_at({7, 7}), Terrain::Mountain);
+
+  for (int row = 0; row < 8; ++row)
+  {
+    for (int column = 0; column < 8; ++column)
+    {
+      auto original = game.board->machine_at({row, column});
+      auto machine = decoded.board->machine_at({row, column});
+      ASSERT_EQ(original == nullptr, machine == nullptr);
+      if (original == nullptr)
+        continue;
+
+      EXPECT_EQ(&machine->machine.get(), &original->machine.get());
+      EXPECT_EQ(machine->health, original->health);
+      EXPECT_EQ(machine->direction, original->direction);
+      EXPECT_EQ(machine->machine_state, original->machine_state);
+      EXPECT_EQ(machine->side, original->side);
+    }
+  }
+
+  EXPECT_EQ(pack_position(decoded).data().size(), packed.size);
+  EXPECT_TRUE(std::equal(packed.data().begin(), packed.data().end(), pack_position(decoded).data().begin()));
+}
+
+TEST(machine_strike_engine_test, Position_text_round_trips_newgame_format)
+{
+  std::string terrain = "FFFGFHFGmGGFGFHGHGFFFHFGHGFGGFGGGGFGGFGHGFHFFFGHGHFGFGGmGFHFGFFF";
+  std::string machines = ";;;;;;Snapmaw,S,O;;Ravager,S,O;;;Burrower,S,O;;;;;;;Scrapper,S,O;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;Longleg,N,P;;;Charger,N,P;;;Snapmaw,N,P;;;;Grazer,N,P;;Glinthawk,N,P;;";
+
+  auto game = parse_position(terrain, machines, "player");
+  EXPECT_EQ(position_to_string(game), terrain + " " + machines + " player");
+
+  game.board->machine_at({0, 6})->health = 2;
+  auto reparsed = parse_position(terrain, machines_to_string(game), "opponent");
+  EXPECT_EQ(reparsed.board->machine_at({0, 6})->health, 2);
+  EXPECT_EQ(reparsed.turn, Player::Opponent);
+}
+
+TEST(machine_strike_engine_test, Game_record_replays_and_verifies_actions)
+{
+  auto game = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(LONGLEG), MachineDirection::North, {6, 1}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(GRAZER), MachineDirection::North, {7, 3}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(SCRAPPER), MachineDirection::South, {2, 2}, MachineState::Ready, Player::Opponent)});
+  GameRecord record(game);
+
+  auto friendly = game.board->machine_at({6, 1});
+  auto move = get_move_with_destination_coords(game, friendly, {4, 2});
+  record.add_action(Action::from_move(move));
+  game.make_move(move);
+
+  auto attack = game.calculate_attacks(friendly)[0];
+  record.add_action(Action::from_attack(attack));
+  game.make_attack(attack);
+
+  auto second_move = get_move_with_destination_coords(game, game.board->machine_at({7, 3}), {7, 4});
+  record.add_action(Action::from_move(second_move));
+  game.make_move(second_move);
+
+  record.add_action(Action::rotate({7, 4}, MachineDirection::West));
+  game.board->machine_at({7, 4})->direction = MachineDirection::West;
+  record.add_action(Action::end_turn());
+  game.end_turn();
+
+  auto loaded = GameRecord::deserialize(record.serialize());
+  auto replayed = unpack_position(loaded.initial_position);
+  auto result = replay_actions(replayed, loaded, true);
+
+  EXPECT_TRUE(result.ok) << result.error;
+  EXPECT_EQ(result.actions_applied, 5);
+  EXPECT_EQ(position_to_string(replayed), position_to_string(game));
+
+  // Ending the turn a second time is not legal without touching a machine first.
+  loaded.add_action(Action::end_turn());
+  result = replay_record(loaded, true);
+  EXPECT_FALSE(result.ok);
+  EXPECT_EQ(result.actions_applied, 5);
+}
+
+TEST(machine_strike_engine_test, Search_takes_the_winning_attack)
+{
+  auto game = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(BURROWER), MachineDirection::North, {4, 3}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(BURROWER), MachineDirection::North, {0, 0}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(BURROWER), MachineDirection::South, {3, 3}, MachineState::Ready, Player::Opponent),
+                           GameMachine(std::ref(BURROWER), MachineDirection::South, {0, 7}, MachineState::Ready, Player::Opponent)});
+  game.player_victory_points = 6;
+  game.board->machine_at({3, 3})->health = 1;
+
+  SearchConfig config;
+  config.seconds = 0;
+  config.max_depth = 2;
+  auto result = game.search(config);
+
+  ASSERT_TRUE(result.best_action.has_value());
+  EXPECT_EQ(result.best_action->type, ActionType::Attack);
+  EXPECT_EQ(result.best_action->direction, MachineDirection::North);
+  EXPECT_GE(result.score, WIN_SCORE - 2);
+}
+
+TEST(machine_strike_engine_test, Search_stats_account_for_every_node)
+{
+  auto game = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(GRAZER), MachineDirection::North, {6, 3}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(BURROWER), MachineDirection::North, {6, 5}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(SCRAPPER), MachineDirection::South, {2, 3}, MachineState::Ready, Player::Opponent),
+                           GameMachine(std::ref(BURROWER), MachineDirection::South, {1, 5}, MachineState::Ready, Player::Opponent)});
+
+  SearchConfig config;
+  config.seconds = 0;
+  config.max_depth = 4;
+  auto result = game.search(config);
+  auto totals = result.stats.total();
+
+  EXPECT_EQ(totals.nodes, result.nodes);
+  EXPECT_EQ(result.stats.plies[0].nodes, 4); // One root node per iteration
+  EXPECT_GT(totals.leaf_evaluations, 0);
+  EXPECT_GT(totals.tt_stores, 0);
+  EXPECT_LE(totals.tt_hits, totals.tt_probes);
+  EXPECT_LE(totals.first_move_cutoffs, totals.beta_cutoffs);
+  EXPECT_GT(result.stats.generator_calls[static_cast<int>(MachineType::Ram)], 0);
+}
+
+TEST(machine_strike_engine_test, Tablebase_solves_one_against_one_and_scores_search_leaves)
+{
+  BoardType<Terrain> terrain{Terrain::Chasm};
+  for (int row = 0; row < 3; ++row)
+  {
+    for (int column = 0; column < 3; ++column)
+      terrain[{row, column}] = Terrain::Grassland;
+  }
+
+  auto game = create_game(terrain, Player::Player,
+                          {GameMachine(std::ref(LONGLEG), MachineDirection::North, {0, 0}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(BURROWER), MachineDirection::South, {1, 1}, MachineState::Ready, Player::Opponent)});
+  game.player_victory_points = 6;
+  game.opponent_victory_points = 6;
+  game.board->machine_at({0, 0})->health = 2;
+  game.board->machine_at({1, 1})->health = 2;
+
+  auto path = (std::filesystem::temp_directory_path() / "machine_strike_engine_test.mstb").string();
+  auto summary = build_tablebase(game, path, 2);
+  EXPECT_EQ(summary.positions, 2 * 73 * 73); // 9 spaces * 4 facings * 2 health + dead, for each machine
+  EXPECT_GT(summary.wins, 0);
+  EXPECT_GT(summary.losses, 0);
+
+  auto tablebase = std::make_shared<Tablebase>(path);
+  auto player_result = tablebase->probe(game, Player::Player);
+  ASSERT_TRUE(player_result.has_value());
+  EXPECT_EQ(player_result->outcome, TablebaseOutcome::Loss);
+  EXPECT_EQ(player_result->turns, 2);
+
+  auto opponent_result = tablebase->probe(game, Player::Opponent);
+  ASSERT_TRUE(opponent_result.has_value());
+  EXPECT_EQ(opponent_result->outcome, TablebaseOutcome::Win);
+  EXPECT_EQ(opponent_result->turns, 1);
+
+  SearchConfig config;
+  config.seconds = 0;
+  config.max_depth = 3;
+  config.tablebase = tablebase;
+  auto result = game.search(config);
+  EXPECT_GT(result.stats.total().tablebase_hits, 0);
+  EXPECT_LE(result.score, -(WIN_SCORE - 10));
+
+  tablebase = nullptr;
+  std::filesystem::remove(path);
+}
+
+TEST(machine_strike_engine_test, File_backed_transposition_table_survives_reopening)
+{
+  auto path = (std::filesystem::temp_directory_path() / "machine_strike_engine_test.mstt").string();
+  std::filesystem::remove(path);
+
+  auto action = Action::end_turn();
+  {
+    TranspositionTable table(1, path);
+    EXPECT_EQ(table.path(), path);
+    table.store(0x123456789ABCDEF, 5, -42, ScoreBound::Lower, action);
+  }
+
+  {
+    TranspositionTable table(1, path);
+    auto entry = table.probe(0x123456789ABCDEF);
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(entry->depth, 5);
+    EXPECT_EQ(entry->score, -42);
+    EXPECT_EQ(entry->bound, ScoreBound::Lower);
+    EXPECT_EQ(entry->best_action(), action);
+    EXPECT_FALSE(table.probe(0x123456789ABCDEE).has_value());
+  }
+
+  // A damaged header wipes the table rather than trusting its slots.
+  {
+    std::fstream stream(path, std::ios::in | std::ios::out | std::ios::binary);
+    stream.seekp(8);
+    stream.put(0x7F);
+  }
+
+  {
+    TranspositionTable table(1, path);
+    EXPECT_EQ(table.path(), path);
+    EXPECT_FALSE(table.probe(0x123456789ABCDEF).has_value());
+  }
+
+  std::filesystem::remove(path);
+}
+
+TEST(machine_strike_engine_test, Transposition_buckets_keep_the_deepest_and_newest_entries)
+{
+  // A 1 MB table has 16384 buckets, so these keys all share one.
+  TranspositionTable table(1);
+  auto key = [](uint64_t i)
+  { return 0x5A5A000000000007 + (i << 14); };
+
+  for (uint64_t i = 0; i < 4; ++i)
+    table.store(key(i), 2 + static_cast<int32_t>(i), 0, ScoreBound::Exact, std::nullopt);
+  for (uint64_t i = 0; i < 4; ++i)
+    EXPECT_TRUE(table.probe(key(i)).has_value());
+
+  // A fifth position takes the shallowest slot.
+  table.store(key(4), 4, 0, ScoreBound::Exact, std::nullopt);
+  EXPECT_FALSE(table.probe(key(0)).has_value());
+  EXPECT_TRUE(table.probe(key(1)).has_value());
+  EXPECT_TRUE(table.probe(key(4)).has_value());
+
+  // A shallower result does not replace a deeper one from the same search, but does once that search is over.
+  table.store(key(3), 1, 7, ScoreBound::Exact, std::nullopt);
+  EXPECT_EQ(table.probe(key(3))->depth, 5);
+  table.new_search();
+  table.store(key(3), 1, 7, ScoreBound::Exact, std::nullopt);
+  EXPECT_EQ(table.probe(key(3))->depth, 1);
+
+  // Entries from earlier searches go before deeper ones from this search.
+  table.store(key(5), 1, 0, ScoreBound::Exact, std::nullopt);
+  EXPECT_TRUE(table.probe(key(3)).has_value());
+  EXPECT_TRUE(table.probe(key(5)).has_value());
+  EXPECT_FALSE(table.probe(key(1)).has_value());
+}
+
+TEST(machine_strike_engine_test, Threaded_search_finds_the_same_win)
+{
+  auto game = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(LONGLEG), MachineDirection::North, {6, 1}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(SCRAPPER), MachineDirection::South, {2, 2}, MachineState::Ready, Player::Opponent)});
+  game.player_victory_points = 6;
+
+  SearchConfig config;
+  config.seconds = 0;
+  config.max_depth = 4;
+  auto single = game.search(config);
+  config.threads = 4;
+  auto threaded = game.search(config);
+
+  ASSERT_TRUE(threaded.best_action.has_value());
+  EXPECT_TRUE(game.is_legal_action(threaded.best_action.value()));
+  EXPECT_EQ(threaded.score, single.score);
+  EXPECT_GE(threaded.nodes, single.nodes);
+}
+
+TEST(machine_strike_engine_test, Opening_book_answers_search_from_records)
+{
+  auto game = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(LONGLEG), MachineDirection::North, {6, 1}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(SCRAPPER), MachineDirection::South, {2, 2}, MachineState::Ready, Player::Opponent)});
+  auto move = get_move_with_destination_coords(game, game.board->machine_at({6, 1}), {4, 2});
+
+  auto directory = std::filesystem::temp_directory_path() / "machine_strike_engine_test_book";
+  std::filesystem::create_directories(directory);
+  for (auto name : {"a.msr", "b.msr"})
+  {
+    GameRecord record(game);
+    record.add_action(Action::from_move(move));
+    record.save((directory / name).string());
+  }
+
+  BookBuildConfig config;
+  config.record_directory = directory.string();
+  config.search_positions = false;
+  auto path = (directory / "book.msob").string();
+  auto summary = build_opening_book(config, path);
+  EXPECT_EQ(summary.records, 2);
+  EXPECT_EQ(summary.positions, 1);
+
+  auto book = std::make_shared<OpeningBook>(path);
+  auto entry = book->probe(game.canonical_hash().first);
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(entry->games, 2);
+  EXPECT_FALSE(book->probe(game.canonical_hash().first + 1).has_value());
+
+  SearchConfig search_config;
+  search_config.opening_book = book;
+  auto result = game.search(search_config);
+  EXPECT_TRUE(result.from_book);
+  EXPECT_EQ(result.best_action, Action::from_move(move));
+  EXPECT_EQ(result.nodes, 0);
+
+  book = nullptr;
+  std::filesystem::remove_all(directory);
+}
+
+TEST(machine_strike_engine_test, Mirrored_positions_share_canonical_hash_and_table_entries)
+{
+  auto game = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(BURROWER), MachineDirection::North, {6, 1}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(SCRAPPER), MachineDirection::East, {2, 2}, MachineState::Ready, Player::Opponent)});
+  auto mirror = create_game(all_grassland, Player::Player,
+                            {GameMachine(std::ref(BURROWER), MachineDirection::North, {6, 6}, MachineState::Ready, Player::Player),
+                             GameMachine(std::ref(SCRAPPER), MachineDirection::West, {2, 5}, MachineState::Ready, Player::Opponent)});
+
+  EXPECT_NE(game.hash(), mirror.hash());
+  EXPECT_EQ(game.canonical_hash().first, mirror.canonical_hash().first);
+  EXPECT_NE(game.canonical_hash().second, mirror.canonical_hash().second);
+
+  auto attack = Action(ActionType::Attack, {2, 2}, {0, 0}, MachineDirection::East, true, false);
+  EXPECT_EQ(attack.mirrored().source, Coord(2, 5));
+  EXPECT_EQ(attack.mirrored().direction, MachineDirection::West);
+  EXPECT_EQ(attack.mirrored().mirrored(), attack);
+
+  // A search of one position leaves a best action that is legal, mapped back, in the other.
+  SearchConfig config;
+  config.seconds = 0;
+  config.max_depth = 2;
+  config.transposition_table = std::make_shared<TranspositionTable>(1);
+  game.search(config);
+
+  auto [key, mirrored] = mirror.canonical_hash();
+  auto entry = config.transposition_table->probe(key);
+  ASSERT_TRUE(entry.has_value());
+  ASSERT_TRUE(entry->best_action().has_value());
+  auto action = mirrored ? entry->best_action()->mirrored() : entry->best_action().value();
+  EXPECT_TRUE(mirror.is_legal_action(action));
+
+  // A machine whose left and right sides differ has no mirror.
+  auto asymmetric = create_game(all_grassland, Player::Player,
+                                {GameMachine(std::ref(SHELLWALKER), MachineDirection::North, {6, 1}, MachineState::Ready, Player::Player)});
+  EXPECT_EQ(asymmetric.canonical_hash(), std::make_pair(asymmetric.hash(), false));
+}
+
+TEST(machine_strike_engine_test, Game_copies_recycle_pooled_machines_and_boards)
+{
+  auto game = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(BURROWER), MachineDirection::North, {6, 1}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(SCRAPPER), MachineDirection::East, {2, 2}, MachineState::Ready, Player::Opponent)});
+
+  // A copy takes its machines and board from this thread's free slots and gives them back when it goes away.
+  {
+    Game copy(game);
+  }
+  auto free_machines = ObjectPool<GameMachine>::thread_cache_size();
+  auto free_boards = ObjectPool<Board>::thread_cache_size();
+  {
+    Game copy(game);
+    EXPECT_EQ(ObjectPool<GameMachine>::thread_cache_size(), free_machines - 2);
+    EXPECT_EQ(ObjectPool<Board>::thread_cache_size(), free_boards - 1);
+    EXPECT_EQ(copy.hash(), game.hash());
+  }
+  EXPECT_EQ(ObjectPool<GameMachine>::thread_cache_size(), free_machines);
+  EXPECT_EQ(ObjectPool<Board>::thread_cache_size(), free_boards);
+
+  // A search hands everything back to the shared pool once it is done.
+  SearchConfig config;
+  config.seconds = 0;
+  config.max_depth = 2;
+  game.search(config);
+  EXPECT_EQ(ObjectPool<GameMachine>::thread_cache_size(), 0);
+  EXPECT_EQ(ObjectPool<Board>::thread_cache_size(), 0);
+}
+
+TEST(machine_strike_engine_test, Machine_table_matches_definitions)
+{
+  for (size_t id = 0; id < ALL_MACHINES.size(); ++id)
+  {
+    const auto &machine = ALL_MACHINES[id].get();
+    EXPECT_EQ(MACHINE_TABLE.attack[id], machine.attack);
+    EXPECT_EQ(MACHINE_TABLE.range[id], machine.range);
+    EXPECT_EQ(MACHINE_TABLE.movement[id], machine.movement);
+    EXPECT_EQ(MACHINE_TABLE.flying[id], machine.is_flying());
+
+    for (auto facing : {MachineDirection::North, MachineDirection::East, MachineDirection::South, MachineDirection::West})
+    {
+      for (auto attack_direction : {MachineDirection::North, MachineDirection::East, MachineDirection::South, MachineDirection::West})
+      {
+        auto side = side_tangent_to_direction(attack_direction, facing);
+        auto expected = static_cast<int32_t>(side & machine.armored_sides) != 0 ? 1 : static_cast<int32_t>(side & machine.weak_sides) != 0 ? -1
+                                                                                                                                           : 0;
+        EXPECT_EQ(MACHINE_TABLE.side_modifier(static_cast<int32_t>(id), facing, attack_direction), expected);
+      }
+    }
+  }
+
+  // A range 3 machine two spaces from the east edge only reaches those two spaces.
+  auto id = machine_id(BILEGUT);
+  EXPECT_EQ(MACHINE_TABLE.reach(id, 3 * 8 + 5, MachineDirection::East), 2);
+  EXPECT_EQ(MACHINE_TABLE.rays[3 * 8 + 5][static_cast<int32_t>(MachineDirection::East)].squares[1], 3 * 8 + 7);
+  EXPECT_EQ(GameMachine(std::ref(BILEGUT), MachineDirection::North, {3, 5}, MachineState::Ready, Player::Player).id, id);
+}
+
+TEST(machine_strike_engine_test, Sweeping_gunner_hits_both_sides_of_its_target)
+{
+  auto game = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(RAVAGER), MachineDirection::North, {4, 3}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(BEHEMOTH), MachineDirection::North, {4, 6}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(BURROWER), MachineDirection::South, {2, 3}, MachineState::Ready, Player::Opponent),
+                           GameMachine(std::ref(BURROWER), MachineDirection::South, {2, 4}, MachineState::Ready, Player::Opponent),
+                           GameMachine(std::ref(BURROWER), MachineDirection::South, {2, 6}, MachineState::Ready, Player::Opponent),
+                           GameMachine(std::ref(BURROWER), MachineDirection::South, {2, 7}, MachineState::Ready, Player::Opponent)});
+
+  auto sweeping = game.calculate_attacks(game.board->machine_at({4, 3}));
+  ASSERT_EQ(sweeping.size(), 1);
+  EXPECT_EQ(sweeping[0].destination, Coord(2, 3));
+  const auto &affected = sweeping[0].affected_machines;
+  EXPECT_NE(std::find(affected.begin(), affected.end(), Coord(2, 3)), affected.end());
+  EXPECT_NE(std::find(affected.begin(), affected.end(), Coord(2, 4)), affected.end());
+
+  auto plain = game.calculate_attacks(game.board->machine_at({4, 6}));
+  ASSERT_EQ(plain.size(), 1);
+  EXPECT_EQ(plain[0].affected_machines, std::vector<Coord>({{2, 6}}));
+}
+
+TEST(machine_strike_engine_test, Combat_power_margin_compares_attacker_and_first_target)
+{
+  // A Burrower is armored at the front and weak at the rear; everything stands on grassland.
+  auto armored = create_game(all_grassland, Player::Player,
+                             {GameMachine(std::ref(SCRAPPER), MachineDirection::North, {4, 3}, MachineState::Ready, Player::Player),
+                              GameMachine(std::ref(BURROWER), MachineDirection::South, {2, 3}, MachineState::Ready, Player::Opponent)});
+  auto attacks = armored.calculate_attacks(armored.board->machine_at({4, 3}));
+  ASSERT_EQ(attacks.size(), 1);
+  ASSERT_EQ(attacks[0].affected_machines, std::vector<Coord>({{2, 3}}));
+  EXPECT_EQ(armored.combat_power_margin(attacks[0]), SCRAPPER.attack - 1);
+
+  auto weak = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(SCRAPPER), MachineDirection::North, {4, 3}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(BURROWER), MachineDirection::North, {2, 3}, MachineState::Ready, Player::Opponent)});
+  attacks = weak.calculate_attacks(weak.board->machine_at({4, 3}));
+  ASSERT_EQ(attacks.size(), 1);
+  EXPECT_EQ(weak.combat_power_margin(attacks[0]), SCRAPPER.attack + 1);
+
+  auto side = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(SCRAPPER), MachineDirection::North, {4, 3}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(BURROWER), MachineDirection::East, {2, 3}, MachineState::Ready, Player::Opponent)});
+  attacks = side.calculate_attacks(side.board->machine_at({4, 3}));
+  ASSERT_EQ(attacks.size(), 1);
+  EXPECT_EQ(side.combat_power_margin(attacks[0]), SCRAPPER.attack);
+}
+
+TEST(machine_strike_engine_test, Attack_predictions_match_making_the_attack)
+{
+  std::mt19937 rng(7);
+  int32_t attacks_checked = 0;
+
+  for (int32_t game_index = 0; game_index < 20; ++game_index)
+  {
+    auto game = random_starting_position(rng);
+    for (int32_t step = 0; step < 80 && game.check_winner() == Winner::None; ++step)
+    {
+      std::vector<Attack> attacks;
+      std::vector<Move> moves;
+      for (auto machine : game.turn == Player::Player ? game.player_machines : game.opponent_machines)
+      {
+        if (!machine->is_alive())
+          continue;
+        auto machine_attacks = game.calculate_attacks(machine);
+        auto machine_moves = game.calculate_moves(machine);
+        attacks.insert(attacks.end(), machine_attacks.begin(), machine_attacks.end());
+        moves.insert(moves.end(), machine_moves.begin(), machine_moves.end());
+      }
+
+      for (auto &attack : attacks)
+      {
+        auto prediction = game.predict_attack(attack);
+
+        // Machines are matched up with their copies by where they stand before the attack.
+        Game copy(game);
+        std::vector<std::pair<GameMachine *, GameMachine *>> machines;
+        for (auto machine : *game.board)
+          machines.emplace_back(machine, copy.board->machine_at(machine->coordinates));
+        copy.make_attack(attack);
+        ++attacks_checked;
+
+        EXPECT_EQ(copy.player_victory_points - game.player_victory_points, prediction.player_victory_points);
+        EXPECT_EQ(copy.opponent_victory_points - game.opponent_victory_points, prediction.opponent_victory_points);
+        for (auto [original, copied] : machines)
+        {
+          auto predicted = std::find_if(prediction.machines.begin(), prediction.machines.end(), [original](const PredictedMachine &machine)
+                                        { return machine.machine == original; });
+          auto health = predicted == prediction.machines.end() ? original->health : predicted->health;
+          auto coordinates = predicted == prediction.machines.end() ? original->coordinates : predicted->coordinates;
+          auto direction = predicted == prediction.machines.end() ? original->direction : predicted->direction;
+          EXPECT_EQ(copied->health, health);
+          EXPECT_EQ(copied->coordinates, coordinates);
+          EXPECT_EQ(copied->direction, direction);
+        }
+      }
+
+      std::uniform_int_distribution<size_t> pick(0, attacks.size() + moves.size());
+      auto choice = pick(rng);
+      if (choice < attacks.size())
+        game.make_attack(attacks[choice]);
+      else if (choice < attacks.size() + moves.size())
+        game.make_move(moves[choice - attacks.size()]);
+      else if (game.can_end_turn() || (attacks.empty() && moves.empty()))
+        game.end_turn();
+    }
+  }
+
+  EXPECT_GT(attacks_checked, 100);
+}
+
+TEST(machine_strike_engine_test, Late_move_reductions_and_futility_pruning_cut_nodes)
+{
+  // Any of the player's machines can finish off the Behemoth, so the other moves near the horizon are futile.
+  auto game = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(BURROWER), MachineDirection::North, {4, 3}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(GRAZER), MachineDirection::North, {4, 5}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(BEHEMOTH), MachineDirection::South, {3, 4}, MachineState::Ready, Player::Opponent),
+                           GameMachine(std::ref(BURROWER), MachineDirection::South, {1, 6}, MachineState::Ready, Player::Opponent)});
+  game.board->machine_at({3, 4})->health = 1;
+
+  SearchConfig plain;
+  plain.seconds = 0;
+  plain.max_depth = 4;
+  plain.futility_pruning = false;
+  plain.late_move_reductions = false;
+  auto plain_result = game.search(plain);
+
+  auto pruned = plain;
+  pruned.futility_pruning = true;
+  pruned.late_move_reductions = true;
+  auto pruned_result = game.search(pruned);
+  auto totals = pruned_result.stats.total();
+
+  EXPECT_GT(totals.futility_prunes, 0);
+  EXPECT_GT(totals.reductions, 0);
+  EXPECT_LE(totals.re_searches, totals.reductions);
+  EXPECT_LT(pruned_result.nodes, plain_result.nodes);
+  EXPECT_EQ(plain_result.stats.total().futility_prunes + plain_result.stats.total().reductions, 0);
+  EXPECT_TRUE(game.is_legal_action(pruned_result.best_action.value()));
+  EXPECT_EQ(parse_search_config("futility=0,lmr=1,lmrdepth=4").lmr_depth, 4);
+}
+
+TEST(machine_strike_engine_test, Moves_come_from_cached_reachability_and_follow_terrain_changes)
+{
+  auto game = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(BURROWER), MachineDirection::North, {4, 3}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(SCRAPPER), MachineDirection::North, {4, 4}, MachineState::Ready, Player::Player)});
+  game.board->set_terrain({3, 3}, Terrain::Marsh);
+  auto burrower = game.board->machine_at({4, 3});
+  auto reaches = [&game, burrower](Coord coord)
+  {
+    auto moves = game.calculate_moves(burrower);
+    return std::any_of(moves.begin(), moves.end(), [coord](const Move &move)
+                       { return move.destination == coord; });
+  };
+
+  // A walker stops in a marsh, passes over machines but cannot end on them, and sprints one space further.
+  EXPECT_TRUE(reaches({3, 3}));
+  EXPECT_FALSE(reaches({2, 3}));
+  EXPECT_FALSE(reaches({4, 4}));
+  EXPECT_TRUE(reaches({4, 5}));
+  EXPECT_TRUE(reaches({4, 6}));
+  EXPECT_FALSE(reaches({4, 7}));
+
+  const auto &reachable = reachable_spaces(*game.board, {4, 3}, 3, MovementClass::Walker);
+  EXPECT_NE(reachable.mask & (uint64_t(1) << (4 * 8 + 4)), 0);
+
+  // Changing the terrain changes the hash the cache is keyed by.
+  auto terrain_hash = game.board->terrain->hash;
+  game.board->set_terrain({3, 3}, Terrain::Grassland);
+  EXPECT_NE(game.board->terrain->hash, terrain_hash);
+  EXPECT_TRUE(reaches({2, 3}));
+
+  game.board->set_terrain({3, 3}, Terrain::Marsh);
+  EXPECT_EQ(game.board->terrain->hash, terrain_hash);
+  EXPECT_FALSE(reaches({2, 3}));
+}
+
+TEST(machine_strike_engine_test, Game_copies_share_terrain_until_it_changes)
+{
+  auto game = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(BURROWER), MachineDirection::North, {4, 3}, MachineState::Ready, Player::Player)});
+  Game copy(game);
+  EXPECT_EQ(copy.board->terrain, game.board->terrain);
+
+  // Changing the copy's terrain leaves the original's alone.
+  copy.board->set_terrain({2, 2}, Terrain::Chasm);
+  EXPECT_NE(copy.board->terrain, game.board->terrain);
+  EXPECT_EQ(game.board->terrain_at({2, 2}), Terrain::Grassland);
+  EXPECT_EQ(copy.board->terrain_at({2, 2}), Terrain::Chasm);
+  EXPECT_EQ(copy.board->terrain->chasm_mask, uint64_t(1) << (2 * 8 + 2));
+  EXPECT_NE(copy.board->terrain->hash, game.board->terrain->hash);
+
+  Game grandchild(copy);
+  EXPECT_EQ(grandchild.board->terrain, copy.board->terrain);
+
+  // Setting a space to the terrain it already has keeps the shared layer.
+  auto shared = game.board->terrain;
+  game.board->set_terrain({2, 2}, Terrain::Grassland);
+  EXPECT_EQ(game.board->terrain, shared);
+}
+
+TEST(machine_strike_engine_test, Staged_generation_skips_moves_after_cutoffs)
+{
+  auto game = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(BURROWER), MachineDirection::North, {4, 3}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(GRAZER), MachineDirection::North, {4, 5}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(BEHEMOTH), MachineDirection::South, {3, 4}, MachineState::Ready, Player::Opponent),
+                           GameMachine(std::ref(BURROWER), MachineDirection::South, {1, 6}, MachineState::Ready, Player::Opponent)});
+
+  SearchConfig config;
+  config.seconds = 0;
+  config.max_depth = 4;
+  config.futility_pruning = false;
+  config.late_move_reductions = false;
+  auto result = game.search(config);
+  auto totals = result.stats.total();
+
+  // Generating attacks and moves for both machines at every node that is not a leaf would take four calls a node.
+  uint64_t calls = 0;
+  for (auto type_calls : result.stats.generator_calls)
+    calls += type_calls;
+  EXPECT_GT(totals.beta_cutoffs, 0);
+  EXPECT_LT(calls, (result.nodes - totals.leaf_evaluations) * 2);
+  EXPECT_TRUE(game.is_legal_action(result.best_action.value()));
+}
+
+TEST(machine_strike_engine_test, Multi_pv_search_reports_distinct_lines_best_first)
+{
+  auto game = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(BURROWER), MachineDirection::North, {4, 3}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(GRAZER), MachineDirection::North, {4, 5}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(BEHEMOTH), MachineDirection::South, {3, 4}, MachineState::Ready, Player::Opponent),
+                           GameMachine(std::ref(BURROWER), MachineDirection::South, {1, 6}, MachineState::Ready, Player::Opponent)});
+
+  SearchConfig config = parse_search_config("seconds=0,depth=3,multipv=3");
+  auto result = game.search(config);
+
+  ASSERT_EQ(result.lines.size(), 3);
+  EXPECT_EQ(result.lines[0].action, result.best_action.value());
+  EXPECT_EQ(result.lines[0].score, result.score);
+  EXPECT_EQ(result.lines[0].principal_variation, result.principal_variation);
+  for (size_t i = 0; i < result.lines.size(); ++i)
+  {
+    EXPECT_TRUE(game.is_legal_action(result.lines[i].action));
+    EXPECT_EQ(result.lines[i].principal_variation.front(), result.lines[i].action);
+    for (size_t j = 0; j < i; ++j)
+    {
+      EXPECT_NE(result.lines[i].action, result.lines[j].action);
+      EXPECT_GE(result.lines[j].score, result.lines[i].score);
+    }
+  }
+
+  // A single line search reports just its best action.
+  config.multi_pv = 1;
+  EXPECT_EQ(game.search(config).lines.size(), 1);
+}
+
+TEST(machine_strike_engine_test, Deterministic_node_limited_search_repeats_exactly)
+{
+  auto game = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(BURROWER), MachineDirection::North, {4, 3}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(GRAZER), MachineDirection::North, {4, 5}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(BEHEMOTH), MachineDirection::South, {3, 4}, MachineState::Ready, Player::Opponent),
+                           GameMachine(std::ref(BURROWER), MachineDirection::South, {1, 6}, MachineState::Ready, Player::Opponent)});
+
+  // A shared table, helper threads and a time limit would all make repeated searches differ, so they are ignored.
+  auto config = parse_search_config("seconds=0.001,nodes=20000,deterministic=1,threads=4");
+  config.transposition_table = std::make_shared<TranspositionTable>(1);
+  auto first = game.search(config);
+  auto second = game.search(config);
+
+  EXPECT_EQ(first.nodes, second.nodes);
+  EXPECT_EQ(first.depth, second.depth);
+  EXPECT_EQ(first.score, second.score);
+  EXPECT_EQ(first.best_action, second.best_action);
+  EXPECT_EQ(first.principal_variation, second.principal_variation);
+  EXPECT_GE(first.nodes, config.max_nodes);
+  EXPECT_LT(first.nodes, config.max_nodes + 1000);
+  EXPECT_FALSE(config.transposition_table->probe(game.canonical_hash().first).has_value());
+}
+
+TEST(machine_strike_engine_test, Time_manager_budgets_from_the_clock)
+{
+  GameClock clock;
+  clock.remaining_seconds = 60;
+  clock.increment_seconds = 1;
+  TimeManager manager(clock);
+  EXPECT_GT(manager.soft_seconds(), clock.increment_seconds * 0.5);
+  EXPECT_GT(manager.hard_seconds(), manager.soft_seconds());
+  EXPECT_LE(manager.hard_seconds(), clock.remaining_seconds / 2);
+
+  // Nearly out of time, the search still finishes well inside what is left.
+  clock.remaining_seconds = 0.5;
+  clock.increment_seconds = 0;
+  TimeManager short_manager(clock);
+  EXPECT_LT(short_manager.hard_seconds(), clock.remaining_seconds / 2);
+
+  // A settled best action stops sooner than one that keeps changing.
+  auto a = Action::end_turn();
+  auto b = Action::rotate({4, 3}, MachineDirection::East);
+  TimeManager settled(GameClock{60, 1, 0});
+  TimeManager unsettled(GameClock{60, 1, 0});
+  auto elapsed = settled.soft_seconds() * 0.5;
+  for (int i = 0; i < 6; ++i)
+  {
+    settled.next_iteration(a, 0, 10, 0);
+    unsettled.next_iteration(i % 2 == 0 ? a : b, 0, 10, 0);
+  }
+  EXPECT_FALSE(settled.next_iteration(a, 0, 10, elapsed));
+  EXPECT_TRUE(unsettled.next_iteration(b, 0, 10, elapsed));
+  // With a single legal action there is nothing to think about.
+  EXPECT_FALSE(unsettled.next_iteration(a, 0, 1, 0));
+
+  // A best action that holds without its score falling stops the search well inside the soft limit, but not one
+  // whose score keeps dropping.
+  TimeManager dominant(GameClock{60, 1, 0});
+  TimeManager slipping(GameClock{60, 1, 0});
+  auto early = dominant.soft_seconds() * 0.2;
+  for (int i = 0; i < 5; ++i)
+  {
+    EXPECT_TRUE(dominant.next_iteration(a, i, 10, 0));
+    EXPECT_TRUE(slipping.next_iteration(a, -i, 10, 0));
+  }
+  EXPECT_FALSE(dominant.next_iteration(a, 5, 10, early));
+  EXPECT_TRUE(slipping.next_iteration(a, -5, 10, early));
+
+  auto game = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(BURROWER), MachineDirection::North, {4, 3}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(GRAZER), MachineDirection::North, {4, 5}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(BEHEMOTH), MachineDirection::South, {3, 4}, MachineState::Ready, Player::Opponent),
+                           GameMachine(std::ref(BURROWER), MachineDirection::South, {1, 6}, MachineState::Ready, Player::Opponent)});
+  auto config = parse_search_config("time=0.5,increment=0,actions=10");
+  ASSERT_TRUE(config.clock.has_value());
+  EXPECT_EQ(config.clock->actions_played, 10);
+  auto result = game.search(config);
+  EXPECT_GE(result.depth, 1);
+  EXPECT_LT(result.seconds, TimeManager(config.clock.value()).hard_seconds() + 0.05);
+}
+
+TEST(machine_strike_engine_test, Evaluation_cache_hits_without_changing_the_search)
+{
+  auto game = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(BURROWER), MachineDirection::North, {4, 3}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(GRAZER), MachineDirection::North, {4, 5}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(BEHEMOTH), MachineDirection::South, {3, 4}, MachineState::Ready, Player::Opponent),
+                           GameMachine(std::ref(BURROWER), MachineDirection::South, {1, 6}, MachineState::Ready, Player::Opponent)});
+
+  auto cached = parse_search_config("seconds=0,depth=4,evalcache=4096");
+  auto uncached = parse_search_config("seconds=0,depth=4,evalcache=0");
+  auto cached_result = game.search(cached);
+  auto uncached_result = game.search(uncached);
+
+  EXPECT_EQ(cached_result.nodes, uncached_result.nodes);
+  EXPECT_EQ(cached_result.score, uncached_result.score);
+  EXPECT_EQ(cached_result.principal_variation, uncached_result.principal_variation);
+
+  auto totals = cached_result.stats.total();
+  EXPECT_GT(totals.eval_cache_hits, 0);
+  EXPECT_LE(totals.eval_cache_hits, totals.eval_cache_probes);
+  EXPECT_LT(totals.quiescence_nodes, uncached_result.stats.total().quiescence_nodes);
+  EXPECT_EQ(uncached_result.stats.total().eval_cache_probes, 0);
+}
+
+TEST(machine_strike_engine_test, Threat_maps_follow_moves_and_deaths)
+{
+  std::mt19937 rng(11);
+  int32_t positions_checked = 0;
+
+  for (int32_t game_index = 0; game_index < 10; ++game_index)
+  {
+    auto game = random_starting_position(rng);
+    for (int32_t step = 0; step < 120 && game.check_winner() == Winner::None; ++step)
+    {
+      EXPECT_NO_THROW(game.verify_threat_maps());
+
+      // Worked out from each machine's range, without the board's masks.
+      std::array<uint64_t, 2> threatened{};
+      for (auto machine : *game.board)
+      {
+        for (int32_t space = 0; space < 64; ++space)
+        {
+          auto distance = std::abs(space / 8 - machine->coordinates.row) + std::abs(space % 8 - machine->coordinates.column);
+          bool in_line = space / 8 == machine->coordinates.row || space % 8 == machine->coordinates.column;
+          if (!in_line || distance == 0 || distance >= machine->machine.get().range)
+            continue;
+
+          threatened[static_cast<int32_t>(machine->side)] |= uint64_t(1) << space;
+          EXPECT_NE(game.attackers_of({space / 8, space % 8}, machine->side) & (uint64_t(1) << (machine->coordinates.row * 8 + machine->coordinates.column)), 0);
+        }
+      }
+      EXPECT_EQ(game.threatened_spaces(Player::Player), threatened[0]);
+      EXPECT_EQ(game.threatened_spaces(Player::Opponent), threatened[1]);
+      ++positions_checked;
+
+      std::vector<Attack> attacks;
+      std::vector<Move> moves;
+      for (auto machine : game.turn == Player::Player ? game.player_machines : game.opponent_machines)
+      {
+        if (!machine->is_alive())
+          continue;
+        auto machine_attacks = game.calculate_attacks(machine);
+        auto machine_moves = game.calculate_moves(machine);
+        attacks.insert(attacks.end(), machine_attacks.begin(), machine_attacks.end());
+        moves.insert(moves.end(), machine_moves.begin(), machine_moves.end());
+      }
+
+      // Attacks are favoured so that machines die along the way.
+      std::uniform_int_distribution<size_t> pick(0, 2 * attacks.size() + moves.size());
+      auto choice = pick(rng);
+      if (choice < 2 * attacks.size())
+        game.make_attack(attacks[choice / 2]);
+      else if (choice < 2 * attacks.size() + moves.size())
+        game.make_move(moves[choice - 2 * attacks.size()]);
+      else if (game.can_end_turn() || (attacks.empty() && moves.empty()))
+        game.end_turn();
+    }
+  }
+
+  EXPECT_GT(positions_checked, 200);
+}
+
+TEST(machine_strike_engine_test, Skipping_a_turn_prunes_nodes_that_stay_above_beta)
+{
+  std::mt19937 rng(4);
+  auto game = random_starting_position(rng);
+
+  SearchConfig plain;
+  plain.seconds = 0;
+  plain.max_depth = 7;
+  plain.null_move_pruning = false;
+  auto plain_result = game.search(plain);
+
+  auto pruned = plain;
+  pruned.null_move_pruning = true;
+  auto pruned_result = game.search(pruned);
+  auto totals = pruned_result.stats.total();
+
+  EXPECT_GT(totals.null_move_searches, 0);
+  EXPECT_GT(totals.null_move_prunes, 0);
+  EXPECT_LE(totals.null_move_prunes, totals.null_move_searches);
+  EXPECT_LT(pruned_result.nodes, plain_result.nodes);
+  EXPECT_EQ(plain_result.stats.total().null_move_searches, 0);
+  EXPECT_TRUE(game.is_legal_action(pruned_result.best_action.value()));
+
+  // With a single machine a side may have to walk into a kill, so neither side ever skips a turn.
+  auto lone = create_game(all_grassland, Player::Player,
+                          {GameMachine(std::ref(BURROWER), MachineDirection::North, {6, 3}, MachineState::Ready, Player::Player),
+                           GameMachine(std::ref(BURROWER), MachineDirection::South, {1, 4}, MachineState::Ready, Player::Opponent)});
+  EXPECT_EQ(lone.search(pruned).stats.total().null_move_searches, 0);
+  EXPECT_EQ(parse_search_config("nullmove=0,nullmovedepth=4,nullmovereduction=3").null_move_reduction, 3);
+  EXPECT_TRUE(parse_search_config("nullmove=1").null_move_pruning);
+  EXPECT_FALSE(SearchConfig().null_move_pruning);
+}
+
+TEST(machine_strike_engine_test, Sprt_log_likelihood_ratio_and_verdicts)
+{
+  SprtConfig sprt;
+  EXPECT_NEAR(sprt.lower_bound(), std::log(0.05 / 0.95), 1e-12);
+  EXPECT_NEAR(sprt.upper_bound(), std::log(0.95 / 0.05), 1e-12);
+  EXPECT_NEAR(sprt.upper_bound(), 2.944439, 1e-6);
+
+  // 60 wins, 20 draws and 20 losses score 0.7 with a per game variance of 0.16. Against elo0 = 0 (a score of 0.5)
+  // and elo1 = 10 (a score of 0.514387), the ratio is 100 * 0.014387 * (1.4 - 0.5 - 0.514387) / 0.32.
+  TournamentResult result;
+  result.wins = 60;
+  result.draws = 20;
+  result.losses = 20;
+  EXPECT_NEAR(log_likelihood_ratio(result, sprt), 1.733713, 1e-6);
+
+  // An even match leans slightly towards H0, since its score sits below the midpoint of the two hypotheses.
+  result.wins = 10;
+  result.draws = 0;
+  result.losses = 10;
+  EXPECT_NEAR(log_likelihood_ratio(result, sprt), -0.008280, 1e-6);
+
+  // No games, or only draws, say nothing.
+  EXPECT_EQ(log_likelihood_ratio(TournamentResult(), sprt), 0);
+  result.wins = result.losses = 0;
+  result.draws = 10;
+  EXPECT_EQ(log_likelihood_ratio(result, sprt), 0);
+
+  // The verdicts fire exactly at the bounds.
+  result.lower_bound = sprt.lower_bound();
+  result.upper_bound = sprt.upper_bound();
+  result.llr = sprt.upper_bound();
+  EXPECT_EQ(result.verdict(), "H1");
+  result.llr = std::nextafter(sprt.upper_bound(), 0.0);
+  EXPECT_EQ(result.verdict(), "-");
+  result.llr = sprt.lower_bound();
+  EXPECT_EQ(result.verdict(), "H0");
+  result.llr = std::nextafter(sprt.lower_bound(), 0.0);
+  EXPECT_EQ(result.verdict(), "-");
+
+  // A clearly stronger candidate crosses the upper bound, a clearly weaker one the lower.
+  result.wins = 150;
+  result.draws = 0;
+  result.losses = 50;
+  result.llr = log_likelihood_ratio(result, sprt);
+  EXPECT_EQ(result.verdict(), "H1");
+  result.wins = 50;
+  result.losses = 150;
+  result.llr = log_likelihood_ratio(result, sprt);
+  EXPECT_EQ(result.verdict(), "H0");
+}